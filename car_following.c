@@ -0,0 +1,227 @@
+#include <stdlib.h>
+#include <string.h>
+#include "car_following.h"
+#include "conflict_grid.h"
+
+// Vehicles in a lane: on the road and not partway through a turn
+static bool followsLane(const VehicleStore *store, int index)
+{
+    return index >= 0 && index < store->activeCount && store->active[index] &&
+           store->state[index] != STATE_TURNING;
+}
+
+static int laneOfIndex(const VehicleStore *store, int index)
+{
+    return laneQueueIndex((Direction)store->direction[index], store->isInRightLane[index]);
+}
+
+// Whether the vehicle's footprint would reach into the intersection box if it
+// were at advance along its lane
+static bool inIntersectionAt(const VehicleStore *store, int index, float advance)
+{
+    const DirectionGeometry *geometry = &DIRECTION_GEOMETRY[store->direction[index]];
+    float x = geometry->axis == AXIS_Y ? store->x[index] : advance * geometry->sign;
+    float y = geometry->axis == AXIS_Y ? advance * geometry->sign : store->y[index];
+    SDL_Rect rect = vehicleFootprint((Direction)store->direction[index], x, y);
+    return footprintCellMask(&rect) != 0;
+}
+
+// Match the per-slot arrays to the store's capacity
+static bool reserveSlots(LaneOrder *order, int capacity)
+{
+    if (capacity <= order->capacity)
+    {
+        return true;
+    }
+    int *laneOf = (int *)realloc(order->laneOf, (size_t)capacity * sizeof(int));
+    if (laneOf == NULL)
+    {
+        return false;
+    }
+    order->laneOf = laneOf;
+    VehicleHandle *leaderOf = (VehicleHandle *)realloc(order->leaderOf, (size_t)capacity * sizeof(VehicleHandle));
+    if (leaderOf == NULL)
+    {
+        return false;
+    }
+    order->leaderOf = leaderOf;
+    for (int slot = order->capacity; slot < capacity; slot++)
+    {
+        order->laneOf[slot] = -1;
+        order->leaderOf[slot] = INVALID_VEHICLE_HANDLE;
+    }
+    order->capacity = capacity;
+    return true;
+}
+
+static bool reserveLane(LaneOrder *order, int lane, int count)
+{
+    if (count <= order->laneCapacity[lane])
+    {
+        return true;
+    }
+    int capacity = order->laneCapacity[lane] > 0 ? order->laneCapacity[lane] : 64;
+    while (capacity < count)
+    {
+        capacity *= 2;
+    }
+    VehicleHandle *grown = (VehicleHandle *)realloc(order->lanes[lane], (size_t)capacity * sizeof(VehicleHandle));
+    if (grown == NULL)
+    {
+        return false;
+    }
+    order->lanes[lane] = grown;
+    order->laneCapacity[lane] = capacity;
+    return true;
+}
+
+void initLaneOrder(LaneOrder *order)
+{
+    memset(order, 0, sizeof(LaneOrder));
+}
+
+void freeLaneOrder(LaneOrder *order)
+{
+    for (int lane = 0; lane < LANE_QUEUE_COUNT; lane++)
+    {
+        free(order->lanes[lane]);
+    }
+    free(order->laneOf);
+    free(order->leaderOf);
+    memset(order, 0, sizeof(LaneOrder));
+}
+
+bool updateLaneOrder(LaneOrder *order, const VehicleStore *store)
+{
+    if (!reserveSlots(order, store->capacity))
+    {
+        return false;
+    }
+
+    // Grow every lane before changing any, so running out of memory leaves
+    // the order as it was. A lane ends up with at most the entries it keeps
+    // plus the awake vehicles now in it.
+    int awakeInLane[LANE_QUEUE_COUNT] = {0};
+    for (int index = 0; index < store->awakeCount; index++)
+    {
+        if (followsLane(store, index))
+        {
+            awakeInLane[laneOfIndex(store, index)]++;
+        }
+    }
+    for (int lane = 0; lane < LANE_QUEUE_COUNT; lane++)
+    {
+        if (!reserveLane(order, lane, order->laneCount[lane] + awakeInLane[lane]))
+        {
+            return false;
+        }
+    }
+
+    // Drop vehicles that are gone or no longer in the lane they are listed in
+    for (int lane = 0; lane < LANE_QUEUE_COUNT; lane++)
+    {
+        VehicleHandle *entries = order->lanes[lane];
+        int kept = 0;
+        for (int k = 0; k < order->laneCount[lane]; k++)
+        {
+            int index = vehicleStoreIndex(store, entries[k]);
+            if (followsLane(store, index) && laneOfIndex(store, index) == lane)
+            {
+                entries[kept++] = entries[k];
+            }
+            else if (VEHICLE_HANDLE_INDEX(entries[k]) < order->capacity &&
+                     order->laneOf[VEHICLE_HANDLE_INDEX(entries[k])] == lane)
+            {
+                order->laneOf[VEHICLE_HANDLE_INDEX(entries[k])] = -1;
+            }
+        }
+        order->laneCount[lane] = kept;
+    }
+
+    // Append vehicles that just entered a lane: spawned, or done turning.
+    // Parked vehicles never change lanes, so only the awake ones are checked.
+    for (int index = 0; index < store->awakeCount; index++)
+    {
+        if (!followsLane(store, index))
+        {
+            continue;
+        }
+        int slot = store->denseToSlot[index];
+        int lane = laneOfIndex(store, index);
+        if (order->laneOf[slot] != lane)
+        {
+            order->lanes[lane][order->laneCount[lane]++] = vehicleStoreHandle(store, index);
+            order->laneOf[slot] = lane;
+        }
+    }
+
+    // Insertion sort, leader first; nearly sorted input makes this linear
+    for (int lane = 0; lane < LANE_QUEUE_COUNT; lane++)
+    {
+        VehicleHandle *entries = order->lanes[lane];
+        for (int k = 1; k < order->laneCount[lane]; k++)
+        {
+            VehicleHandle handle = entries[k];
+            float advance = laneAdvance(store, vehicleStoreIndex(store, handle));
+            int j = k - 1;
+            while (j >= 0 && laneAdvance(store, vehicleStoreIndex(store, entries[j])) < advance)
+            {
+                entries[j + 1] = entries[j];
+                j--;
+            }
+            entries[j + 1] = handle;
+        }
+
+        for (int k = 0; k < order->laneCount[lane]; k++)
+        {
+            order->leaderOf[VEHICLE_HANDLE_INDEX(entries[k])] = k > 0 ? entries[k - 1] : INVALID_VEHICLE_HANDLE;
+        }
+    }
+    return true;
+}
+
+int laneLeader(const LaneOrder *order, const VehicleStore *store, int index)
+{
+    int slot = store->denseToSlot[index];
+    if (slot >= order->capacity || order->laneOf[slot] < 0)
+    {
+        return -1;
+    }
+    return vehicleStoreIndex(store, order->leaderOf[slot]);
+}
+
+void applyCarFollowing(const LaneOrder *order, VehicleStore *store)
+{
+    for (int lane = 0; lane < LANE_QUEUE_COUNT; lane++)
+    {
+        const VehicleHandle *entries = order->lanes[lane];
+        for (int k = 1; k < order->laneCount[lane]; k++)
+        {
+            int leader = vehicleStoreIndex(store, entries[k - 1]);
+            int follower = vehicleStoreIndex(store, entries[k]);
+            float limit = laneAdvance(store, leader) - FOLLOW_SPACING;
+            float advance = laneAdvance(store, follower);
+            if (advance <= limit)
+            {
+                continue;
+            }
+
+            // Moving vehicles advanced by their speed this tick; stopped ones
+            // have speed 0, so this is where the follower started the tick
+            float start = advance - store->speed[follower];
+            // A vehicle crossing the box keeps the profile its crossing was
+            // reserved with (reservation.h), until it is clear of the box
+            if (inIntersectionAt(store, follower, advance) || inIntersectionAt(store, follower, start))
+            {
+                continue;
+            }
+            float allowed = limit > start ? limit : start;
+            setLaneAdvance(store, follower, allowed);
+            if (allowed - start < 0.1f)
+            {
+                store->speed[follower] = 0;
+                store->state[follower] = STATE_STOPPED;
+            }
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef CAR_FOLLOWING_H
+#define CAR_FOLLOWING_H
+
+#include <stdbool.h>
+#include "traffic_simulation.h"
+#include "vehicle_store.h"
+
+// Bumper-to-bumper distance a follower keeps behind its leader
+#define FOLLOW_GAP 8.0f
+// Distance between the positions of a leader and its follower
+#define FOLLOW_SPACING (VEHICLE_LENGTH + FOLLOW_GAP)
+
+// Every physical lane's vehicles ordered by how far along the lane they are,
+// leader first, so a vehicle's leader is simply the entry before it.
+//
+// Vehicles rarely overtake, so the order is kept from tick to tick: entries
+// whose vehicle left the lane (gone, turning, or now in another lane) are
+// dropped, newcomers are appended at the back and an insertion sort puts them
+// in place, which is O(n) when little has changed. Lanes hold handles, so the
+// swap-remove compaction of the store does not disturb them.
+typedef struct {
+    VehicleHandle* lanes[LANE_QUEUE_COUNT];
+    int laneCount[LANE_QUEUE_COUNT];
+    int laneCapacity[LANE_QUEUE_COUNT];
+
+    // Per store slot: lane the slot is listed in (-1 if none) and its leader
+    int* laneOf;
+    VehicleHandle* leaderOf;
+    int capacity;
+} LaneOrder;
+
+void initLaneOrder(LaneOrder* order);
+void freeLaneOrder(LaneOrder* order);
+
+// Bring every lane up to date with the store after the vehicle update. Every
+// lane is grown before any is changed, so if memory runs out this returns
+// false with the lanes left as they were.
+bool updateLaneOrder(LaneOrder* order, const VehicleStore* store);
+
+// How far along its lane the vehicle at a dense index is (alongLane)
+static inline float laneAdvance(const VehicleStore* store, int index)
+{
+    return alongLane(&DIRECTION_GEOMETRY[store->direction[index]], store->x[index], store->y[index]);
+}
+
+// Move the vehicle at a dense index to advance along its lane
+static inline void setLaneAdvance(VehicleStore* store, int index, float advance)
+{
+    const DirectionGeometry* geometry = &DIRECTION_GEOMETRY[store->direction[index]];
+    if (geometry->axis == AXIS_Y)
+    {
+        store->y[index] = advance * geometry->sign;
+    }
+    else
+    {
+        store->x[index] = advance * geometry->sign;
+    }
+}
+// Dense index of the vehicle directly ahead in the same lane, -1 if none
+int laneLeader(const LaneOrder* order, const VehicleStore* store, int index);
+
+// Hard limit behind the driver model (idm.h), which normally keeps the gap
+// by itself: walking each lane from its leader back, pull any
+// follower that closed within FOLLOW_SPACING of its leader back to that
+// distance (never behind where it started the tick). A follower that could
+// not move at all this tick is marked stopped, so it pulls away again like
+// a vehicle at a red light once its leader moves on. A vehicle that joins a
+// lane too close (finishing a turn) is not pushed back; the gap opens as its
+// leader pulls away. Vehicles that were or are in the intersection box this
+// tick are left alone too, so they keep to their reservation (reservation.h).
+void applyCarFollowing(const LaneOrder* order, VehicleStore* store);
+
+#endif
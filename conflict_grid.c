@@ -0,0 +1,205 @@
+#include <stdlib.h>
+#include <string.h>
+#include "conflict_grid.h"
+
+typedef struct {
+    int x0, y0, x1, y1; // inclusive cell range
+} CellRange;
+
+static SDL_Rect storeFootprint(const VehicleStore *store, int index)
+{
+    return vehicleFootprint((Direction)store->direction[index], store->x[index], store->y[index]);
+}
+
+static bool rectsOverlap(const SDL_Rect *a, const SDL_Rect *b)
+{
+    return a->x < b->x + b->w && b->x < a->x + a->w &&
+           a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+static int cellCoordinate(int pixel, int origin)
+{
+    int cell = (pixel - origin) / CONFLICT_CELL_SIZE;
+    if (cell < 0)
+    {
+        return 0;
+    }
+    return cell < CONFLICT_GRID_SIZE ? cell : CONFLICT_GRID_SIZE - 1;
+}
+
+// Cells a footprint touches; false if it lies outside the intersection
+static bool footprintCells(const SDL_Rect *rect, CellRange *range)
+{
+    int right = rect->x + rect->w;
+    int bottom = rect->y + rect->h;
+    if (right <= CONFLICT_GRID_LEFT || rect->x >= CONFLICT_GRID_LEFT + 2 * LANE_WIDTH ||
+        bottom <= CONFLICT_GRID_TOP || rect->y >= CONFLICT_GRID_TOP + 2 * LANE_WIDTH)
+    {
+        return false;
+    }
+    range->x0 = cellCoordinate(rect->x, CONFLICT_GRID_LEFT);
+    range->y0 = cellCoordinate(rect->y, CONFLICT_GRID_TOP);
+    range->x1 = cellCoordinate(right - 1, CONFLICT_GRID_LEFT);
+    range->y1 = cellCoordinate(bottom - 1, CONFLICT_GRID_TOP);
+    return true;
+}
+
+uint64_t footprintCellMask(const SDL_Rect *rect)
+{
+    CellRange range;
+    if (!footprintCells(rect, &range))
+    {
+        return 0;
+    }
+    uint64_t mask = 0;
+    for (int cy = range.y0; cy <= range.y1; cy++)
+    {
+        for (int cx = range.x0; cx <= range.x1; cx++)
+        {
+            mask |= (uint64_t)1 << (cy * CONFLICT_GRID_SIZE + cx);
+        }
+    }
+    return mask;
+}
+
+bool insideIntersection(const VehicleStore *store, int index)
+{
+    SDL_Rect rect = storeFootprint(store, index);
+    CellRange range;
+    return footprintCells(&rect, &range);
+}
+
+void initConflictGrid(ConflictGrid *grid)
+{
+    memset(grid, 0, sizeof(ConflictGrid));
+}
+
+void freeConflictGrid(ConflictGrid *grid)
+{
+    free(grid->entries);
+    memset(grid, 0, sizeof(ConflictGrid));
+}
+
+bool buildConflictGrid(ConflictGrid *grid, const VehicleStore *store)
+{
+    int counts[CONFLICT_GRID_SIZE * CONFLICT_GRID_SIZE] = {0};
+    int total = 0;
+    for (int i = 0; i < store->awakeCount; i++)
+    {
+        SDL_Rect rect = storeFootprint(store, i);
+        CellRange range;
+        if (!store->active[i] || !footprintCells(&rect, &range))
+        {
+            continue;
+        }
+        for (int cy = range.y0; cy <= range.y1; cy++)
+        {
+            for (int cx = range.x0; cx <= range.x1; cx++)
+            {
+                counts[cy * CONFLICT_GRID_SIZE + cx]++;
+                total++;
+            }
+        }
+    }
+
+    memset(grid->cellStart, 0, sizeof(grid->cellStart));
+    if (total > grid->entryCapacity)
+    {
+        int capacity = grid->entryCapacity > 0 ? grid->entryCapacity : 64;
+        while (capacity < total)
+        {
+            capacity *= 2;
+        }
+        int *grown = (int *)realloc(grid->entries, (size_t)capacity * sizeof(int));
+        if (grown == NULL)
+        {
+            return false;
+        }
+        grid->entries = grown;
+        grid->entryCapacity = capacity;
+    }
+
+    // Prefix sum, then fill each cell from its start
+    int fill[CONFLICT_GRID_SIZE * CONFLICT_GRID_SIZE];
+    for (int c = 0; c < CONFLICT_GRID_SIZE * CONFLICT_GRID_SIZE; c++)
+    {
+        grid->cellStart[c + 1] = grid->cellStart[c] + counts[c];
+        fill[c] = grid->cellStart[c];
+    }
+    for (int i = 0; i < store->awakeCount; i++)
+    {
+        SDL_Rect rect = storeFootprint(store, i);
+        CellRange range;
+        if (!store->active[i] || !footprintCells(&rect, &range))
+        {
+            continue;
+        }
+        for (int cy = range.y0; cy <= range.y1; cy++)
+        {
+            for (int cx = range.x0; cx <= range.x1; cx++)
+            {
+                grid->entries[fill[cy * CONFLICT_GRID_SIZE + cx]++] = i;
+            }
+        }
+    }
+    return true;
+}
+
+// A pair sharing several cells is only reported by the cell holding the
+// top-left corner of their overlap
+static bool ownsOverlap(const SDL_Rect *a, const SDL_Rect *b, int cell)
+{
+    int x = a->x > b->x ? a->x : b->x;
+    int y = a->y > b->y ? a->y : b->y;
+    return cellCoordinate(y, CONFLICT_GRID_TOP) * CONFLICT_GRID_SIZE + cellCoordinate(x, CONFLICT_GRID_LEFT) == cell;
+}
+
+int countConflicts(const ConflictGrid *grid, const VehicleStore *store)
+{
+    int conflicts = 0;
+    for (int cell = 0; cell < CONFLICT_GRID_SIZE * CONFLICT_GRID_SIZE; cell++)
+    {
+        for (int a = grid->cellStart[cell]; a < grid->cellStart[cell + 1]; a++)
+        {
+            SDL_Rect first = storeFootprint(store, grid->entries[a]);
+            for (int b = a + 1; b < grid->cellStart[cell + 1]; b++)
+            {
+                SDL_Rect second = storeFootprint(store, grid->entries[b]);
+                if (rectsOverlap(&first, &second) && ownsOverlap(&first, &second, cell))
+                {
+                    conflicts++;
+                }
+            }
+        }
+    }
+    return conflicts;
+}
+
+int findConflicts(const ConflictGrid *grid, const VehicleStore *store, int index, int *out, int maxCount)
+{
+    SDL_Rect rect = storeFootprint(store, index);
+    CellRange range;
+    if (!footprintCells(&rect, &range))
+    {
+        return 0;
+    }
+
+    int found = 0;
+    for (int cy = range.y0; cy <= range.y1; cy++)
+    {
+        for (int cx = range.x0; cx <= range.x1; cx++)
+        {
+            int cell = cy * CONFLICT_GRID_SIZE + cx;
+            for (int e = grid->cellStart[cell]; e < grid->cellStart[cell + 1] && found < maxCount; e++)
+            {
+                int other = grid->entries[e];
+                SDL_Rect otherRect = storeFootprint(store, other);
+                if (other != index && rectsOverlap(&rect, &otherRect) && ownsOverlap(&rect, &otherRect, cell))
+                {
+                    out[found++] = other;
+                }
+            }
+        }
+    }
+    return found;
+}
@@ -0,0 +1,47 @@
+#ifndef CONFLICT_GRID_H
+#define CONFLICT_GRID_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "traffic_simulation.h"
+#include "vehicle_store.h"
+
+// Uniform grid over the intersection box (INTERSECTION_X/Y +- LANE_WIDTH),
+// where turning vehicles cross the other approaches' paths
+#define CONFLICT_GRID_SIZE 8
+#define CONFLICT_CELL_SIZE (2 * LANE_WIDTH / CONFLICT_GRID_SIZE)
+#define CONFLICT_GRID_LEFT (INTERSECTION_X - LANE_WIDTH)
+#define CONFLICT_GRID_TOP (INTERSECTION_Y - LANE_WIDTH)
+
+// Broadphase for conflicts between vehicles in the intersection. The grid is
+// rebuilt every tick with a counting sort: one pass counts how many vehicle
+// footprints touch each cell, a prefix sum turns that into cell offsets, and
+// a second pass files dense indices under every cell they touch. Queries
+// then only compare vehicles that share a cell, so finding conflicts is
+// close to linear in the number of vehicles instead of quadratic.
+typedef struct {
+    int cellStart[CONFLICT_GRID_SIZE * CONFLICT_GRID_SIZE + 1]; // entries of cell c: [cellStart[c], cellStart[c + 1])
+    int* entries;       // dense indices, grouped by cell
+    int entryCapacity;
+} ConflictGrid;
+
+void initConflictGrid(ConflictGrid* grid);
+void freeConflictGrid(ConflictGrid* grid);
+
+// File every awake vehicle (parked ones wait outside the box) whose footprint
+// reaches into the intersection. Returns false if memory ran out; the grid is
+// then empty.
+bool buildConflictGrid(ConflictGrid* grid, const VehicleStore* store);
+// Number of vehicle pairs whose footprints overlap, each pair counted once
+int countConflicts(const ConflictGrid* grid, const VehicleStore* store);
+// One bit per grid cell the footprint touches (bit cy * CONFLICT_GRID_SIZE + cx),
+// 0 if it is outside the intersection
+uint64_t footprintCellMask(const SDL_Rect* rect);
+// True while the footprint of the vehicle at a dense index reaches into the
+// intersection
+bool insideIntersection(const VehicleStore* store, int index);
+// Dense indices of the vehicles overlapping the one at index (up to maxCount);
+// returns how many were found
+int findConflicts(const ConflictGrid* grid, const VehicleStore* store, int index, int* out, int maxCount);
+
+#endif
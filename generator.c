@@ -1,10 +1,12 @@
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include "traffic_simulation.h"
+#include "vehicle_channel.h"
 
 void writeVehicleToFile(FILE *file, Vehicle *vehicle) {
-    fprintf(file, "%f %f %d %d %d %d %d\n", 
+    fprintf(file, "%f %f %d %d %d %d %f\n", 
             vehicle->x, vehicle->y, 
             vehicle->direction, 
             vehicle->type, 
@@ -13,37 +15,70 @@ void writeVehicleToFile(FILE *file, Vehicle *vehicle) {
             vehicle->speed);
 }
 
+// Set by SIGINT/SIGTERM so the loop below exits and the channel is unlinked
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop(int signalNumber) {
+    (void)signalNumber;
+    stopRequested = 1;
+}
+
 int SDL_main(int argc, char *argv[]) {
     srand(time(NULL));
-    FILE *file = fopen("bin/vehicles.txt", "w");
-    if (!file) {
-        perror("Failed to open vehicles.txt");
-        return 1;
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+
+    // Hand vehicles to the simulator through shared memory when available
+    VehicleChannel channel;
+    bool useChannel = openVehicleChannel(&channel, true);
+    uint32_t reportedDrops = 0;
+
+    FILE *file = NULL;
+    if (!useChannel) {
+        file = fopen("bin/vehicles.txt", "w");
+        if (!file) {
+            perror("Failed to open vehicles.txt");
+            return 1;
+        }
     }
 
-    while (1) {
+    while (!stopRequested) {
         // Generation of a new vehicle
         Direction spawnDirection = (Direction)(rand() % 4);
         Vehicle *newVehicle = createVehicle(spawnDirection);
 
-
-        // Write the vehicle data to the file
-        writeVehicleToFile(file, newVehicle);
-        fflush(file); // Ensure data is written to the file immediately
+        if (useChannel) {
+            // Report backpressure when the simulator is not draining fast enough
+            if (!pushVehicleRecord(&channel, newVehicle)) {
+                uint32_t dropped = vehicleChannelDropped(&channel);
+                if (dropped != reportedDrops) {
+                    printf("Simulator falling behind: %u vehicle records dropped\n", dropped);
+                    reportedDrops = dropped;
+                }
+            }
+        } else {
+            // Write the vehicle data to the file
+            writeVehicleToFile(file, newVehicle);
+            fflush(file); // Ensure data is written to the file immediately
+        }
 
         // Free the vehicle memory
         free(newVehicle);
 
-        // Wait for a short period before generating the next vehicle
-        SDL_Delay(2000); // 2 seconds delay
+        // Wait 2 seconds before generating the next vehicle, in short steps
+        // so a stop request is handled promptly
+        for (int waited = 0; waited < 2000 && !stopRequested; waited += 100) {
+            SDL_Delay(100);
+        }
     }
 //vehicle gen delay added
-    fclose(file);
+    if (file) {
+        fclose(file);
+    }
+    closeVehicleChannel(&channel);
     return 0;
 }
 //Use queue operations to enqueue vehicles into their respective lanes
 // Additional comments for future expansion
-// TODO: Implement priority-based queueing for emergency vehicles
-// TODO: Optimize file I/O operations to reduce latency
 // Placeholder for future debugging logs
 // Code formatting check
\ No newline at end of file
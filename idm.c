@@ -0,0 +1,108 @@
+#include <stdlib.h>
+#include <string.h>
+#include "idm.h"
+#include "vehicle_kernels.h"
+#include "conflict_grid.h"
+
+float redLightGap(const VehicleStore *store, int index, const TrafficLight *lights)
+{
+    Direction direction = (Direction)store->direction[index];
+    if (store->type[index] != REGULAR_CAR || lights[direction].state != RED ||
+        store->state[index] == STATE_TURNING)
+    {
+        return IDM_FREE_GAP;
+    }
+
+    // Regular cars stop short of the box, unless they are too close to stop
+    // comfortably and carry on through
+    const DirectionGeometry *geometry = &DIRECTION_GEOMETRY[direction];
+    float front = laneAdvance(store, index) + (geometry->sign > 0 ? VEHICLE_LENGTH : 0);
+    float lightGap = geometry->intersectionEdge * geometry->sign - front;
+    float speed = store->speed[index];
+    float brakingDistance = speed * speed / (2.0f * IDM_PARAMETERS[REGULAR_CAR].comfortDeceleration);
+    return lightGap > 0 && brakingDistance <= lightGap ? lightGap : IDM_FREE_GAP;
+}
+
+static bool reserveInputs(IdmInputs *inputs, int capacity)
+{
+    if (capacity <= inputs->capacity)
+    {
+        return true;
+    }
+    float *gap = (float *)realloc(inputs->gap, (size_t)capacity * sizeof(float));
+    if (gap == NULL)
+    {
+        return false;
+    }
+    inputs->gap = gap;
+    float *leaderSpeed = (float *)realloc(inputs->leaderSpeed, (size_t)capacity * sizeof(float));
+    if (leaderSpeed == NULL)
+    {
+        return false;
+    }
+    inputs->leaderSpeed = leaderSpeed;
+    inputs->capacity = capacity;
+    return true;
+}
+
+void initIdmInputs(IdmInputs *inputs)
+{
+    memset(inputs, 0, sizeof(IdmInputs));
+}
+
+void freeIdmInputs(IdmInputs *inputs)
+{
+    free(inputs->gap);
+    free(inputs->leaderSpeed);
+    memset(inputs, 0, sizeof(IdmInputs));
+}
+
+bool gatherIdmInputs(IdmInputs *inputs, const LaneOrder *order, const VehicleStore *store, const TrafficLight *lights)
+{
+    if (!reserveInputs(inputs, store->capacity))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < store->awakeCount; i++)
+    {
+        float speed = store->speed[i];
+        float gap = IDM_FREE_GAP;
+        float leaderSpeed = speed;
+        // Vehicles in the box drive the free-road profile their reservation
+        // was planned with (reservation.h), whatever is ahead of them
+        if (!store->active[i] || store->state[i] == STATE_TURNING || insideIntersection(store, i))
+        {
+            inputs->gap[i] = gap;
+            inputs->leaderSpeed[i] = leaderSpeed;
+            continue;
+        }
+
+        int leader = laneLeader(order, store, i);
+        if (leader >= 0)
+        {
+            gap = laneAdvance(store, leader) - laneAdvance(store, i) - VEHICLE_LENGTH;
+            leaderSpeed = store->speed[leader];
+        }
+
+        float lightGap = redLightGap(store, i, lights);
+        if (lightGap < gap)
+        {
+            gap = lightGap;
+            leaderSpeed = 0;
+        }
+        inputs->gap[i] = gap;
+        inputs->leaderSpeed[i] = leaderSpeed;
+    }
+    return true;
+}
+
+bool applyDriverModel(IdmInputs *inputs, const LaneOrder *order, VehicleStore *store, const TrafficLight *lights)
+{
+    if (!gatherIdmInputs(inputs, order, store, lights))
+    {
+        return false;
+    }
+    updateIdmSpeeds(store, inputs->gap, inputs->leaderSpeed, 0, store->awakeCount);
+    return true;
+}
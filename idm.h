@@ -0,0 +1,40 @@
+#ifndef IDM_H
+#define IDM_H
+
+#include <stdbool.h>
+#include "traffic_simulation.h"
+#include "vehicle_store.h"
+#include "car_following.h"
+
+// Intelligent Driver Model inputs for every awake vehicle, by dense index:
+// the bumper-to-bumper gap to whatever is ahead and that obstacle's speed.
+// They are two plain float arrays, so updateIdmSpeeds streams them next to
+// the store's speed, type and state columns.
+//
+// What is ahead is the vehicle's leader in the LaneOrder. For a regular car
+// facing a red light that can still stop comfortably, the stop line at the
+// edge of the box counts as a standing obstacle if it is closer. Turning
+// vehicles and lane leaders with nothing ahead get IDM_FREE_GAP.
+typedef struct {
+    float* gap;
+    float* leaderSpeed;
+    int capacity;
+} IdmInputs;
+
+// Gap from a vehicle's front to the stop line when its red light holds it
+// back, IDM_FREE_GAP when the light does not apply to it
+float redLightGap(const VehicleStore* store, int index, const TrafficLight* lights);
+
+void initIdmInputs(IdmInputs* inputs);
+void freeIdmInputs(IdmInputs* inputs);
+
+// Fill the inputs from an up-to-date lane order and the current lights.
+// Vehicles inside the intersection box see a free road, as their crossing was
+// reserved for (reservation.h). Returns false if memory ran out.
+bool gatherIdmInputs(IdmInputs* inputs, const LaneOrder* order, const VehicleStore* store, const TrafficLight* lights);
+
+// Gather, then set every awake vehicle's speed for its next move with the
+// batch kernel. Returns false (speeds unchanged) if memory ran out.
+bool applyDriverModel(IdmInputs* inputs, const LaneOrder* order, VehicleStore* store, const TrafficLight* lights);
+
+#endif
@@ -1,7 +1,27 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include "traffic_simulation.h"
+#include "priority_queue.h"
+#include "vehicle_channel.h"
+#include "vehicle_store.h"
+#include "parallel_update.h"
+#include "car_following.h"
+#include "idm.h"
+#include "wait_lists.h"
+#include "conflict_grid.h"
+#include "reservation.h"
+#include "sim_clock.h"
+
+// Simulated duration of a --headless run unless --duration is given
+#define HEADLESS_DEFAULT_DURATION_MS (10 * 60 * 1000)
+// Simulated time between checks that the generator feeding the channel still runs
+#define CHANNEL_CHECK_INTERVAL_MS 1000
+// Crossed vehicles taken off a lane queue per dequeueN
+#define RELEASE_BATCH 64
+
+#ifndef SIM_HEADLESS
 #include<SDL.h>
 
 void initializeSDL(SDL_Window **window, SDL_Renderer **renderer) {
@@ -26,114 +46,437 @@ void handleEvents(bool *running) {
         }
     }
 }
+#endif
 
 Vehicle readVehicleFromFile(FILE *file) {
     Vehicle vehicle = {0};
-    if (fscanf(file, "%f %f %d %d %d %d %d", 
+    int direction, type, turnDirection, state;
+    if (fscanf(file, "%f %f %d %d %d %d %f", 
            &vehicle.x, &vehicle.y, 
-           (int*)&vehicle.direction, 
-           (int*)&vehicle.type, 
-           (int*)&vehicle.turnDirection, 
-           (int*)&vehicle.state, 
+           &direction, 
+           &type, 
+           &turnDirection, 
+           &state, 
            &vehicle.speed) == 7) {
+        vehicle.direction = (uint8_t)direction;
+        vehicle.type = (uint8_t)type;
+        vehicle.turnDirection = (uint8_t)turnDirection;
+        vehicle.state = (uint8_t)state;
         vehicle.active = true;
-        
-        // Set dimensions based on direction
-        if (vehicle.direction == DIRECTION_NORTH || vehicle.direction == DIRECTION_SOUTH) {
-            vehicle.rect.w = 20;
-            vehicle.rect.h = 30;
+    }
+    return vehicle;
+}
+// Register a newly spawned vehicle with its lane queue and approach priority
+// queue. A vehicle a queue has no room for still drives; it just is not
+// tracked there, and its slot is released as soon as it leaves.
+void queueArrival(VehicleStore *store, VehicleHandle handle) {
+    int index = vehicleStoreIndex(store, handle);
+    int lane = laneQueueIndex(store->direction[index], store->isInRightLane[index]);
+    store->inLaneQueue[index] = enqueue(&laneQueues[lane], handle, &store->queueTicket[index]);
+    store->inPriorityQueue[index] = priorityEnqueue(&priorityLaneQueues[store->direction[index]], handle,
+                                                    store->type[index], &store->priorityTicket[index]);
+    if (!store->inLaneQueue[index] || !store->inPriorityQueue[index]) {
+        fprintf(stderr, "Lane queue is full, vehicle is not queued\n");
+    }
+}
+
+// Register a batch of arrivals with one enqueueN per lane
+void queueArrivals(VehicleStore *store, const VehicleHandle *arrived, int count) {
+    VehicleHandle byLane[LANE_QUEUE_COUNT][VEHICLE_CHANNEL_BATCH];
+    int perLane[LANE_QUEUE_COUNT] = {0};
+    bool dropped = false;
+    for (int a = 0; a < count; a++) {
+        int index = vehicleStoreIndex(store, arrived[a]);
+        int lane = laneQueueIndex(store->direction[index], store->isInRightLane[index]);
+        byLane[lane][perLane[lane]++] = arrived[a];
+        store->inPriorityQueue[index] = priorityEnqueue(&priorityLaneQueues[store->direction[index]], arrived[a],
+                                                        store->type[index], &store->priorityTicket[index]);
+        dropped |= !store->inPriorityQueue[index];
+    }
+    for (int lane = 0; lane < LANE_QUEUE_COUNT; lane++) {
+        if (perLane[lane] == 0) {
+            continue;
+        }
+        // enqueueN queues a prefix of the batch with consecutive tickets
+        unsigned int ticket = 0;
+        int queued = enqueueN(&laneQueues[lane], byLane[lane], perLane[lane], &ticket);
+        for (int k = 0; k < perLane[lane]; k++) {
+            int index = vehicleStoreIndex(store, byLane[lane][k]);
+            store->inLaneQueue[index] = k < queued;
+            store->queueTicket[index] = ticket + (unsigned int)k;
+        }
+        dropped |= queued < perLane[lane];
+    }
+    if (dropped) {
+        fprintf(stderr, "Lane queue is full, vehicles are not queued\n");
+    }
+}
+
+// A vehicle stops counting as waiting on its approach as soon as it crosses
+// the stop line itself, whatever its lane queue's front is doing. Only awake
+// vehicles move, and every vehicle that left is still awake here.
+void releasePriorityEntries(VehicleStore *store) {
+    for (int i = 0; i < store->awakeCount; i++) {
+        if (store->inPriorityQueue[i] &&
+            (!store->active[i] || hasPassedStopLine(store->direction[i], store->x[i], store->y[i]))) {
+            priorityRemove(&priorityLaneQueues[store->direction[i]], store->type[i], store->priorityTicket[i]);
+            store->inPriorityQueue[i] = false;
+        }
+    }
+}
+
+// Pop vehicles off the front of each lane queue once they have cleared the
+// stop line or left the screen, with one dequeueN per lane (one atomic store
+// with QUEUE_MPSC). A slot is only released once its vehicle is gone and no
+// lane queue holds its handle.
+void releaseCrossedVehicles(VehicleStore *store) {
+    VehicleHandle crossed[RELEASE_BATCH];
+    for (int lane = 0; lane < LANE_QUEUE_COUNT; lane++) {
+        int count;
+        do {
+            QueueIterator it = queueBegin(&laneQueues[lane]);
+            VehicleHandle handle;
+            count = 0;
+            while (count < RELEASE_BATCH && queueNext(&it, &handle)) {
+                int index = vehicleStoreIndex(store, handle);
+                if (store->active[index] &&
+                    !hasPassedStopLine(store->direction[index], store->x[index], store->y[index])) {
+                    break;
+                }
+                count++;
+            }
+            count = dequeueN(&laneQueues[lane], crossed, count);
+            for (int c = 0; c < count; c++) {
+                int index = vehicleStoreIndex(store, crossed[c]);
+                store->inLaneQueue[index] = false;
+                if (!store->active[index]) {
+                    vehicleStoreRelease(store, crossed[c]);
+                }
+            }
+        } while (count == RELEASE_BATCH);
+    }
+}
+
+// Everything one simulation step reads or changes
+typedef struct {
+    VehicleStore store;
+    LaneOrder laneOrder;
+    IdmInputs idm;
+    WaitLists waitLists;
+    ConflictGrid conflictGrid;
+    ReservationTable reservations;
+    TrafficLight lights[4];
+    Statistics stats;
+    SimClock clock;
+    UpdatePool* updatePool;
+    VehicleChannel channel;
+    bool useChannel;
+    Uint32 lastChannelCheck;
+    Uint32 lastVehicleSpawn;
+    int vehicleCount;
+} Simulation;
+
+// Advance the simulation by one fixed SIM_TICK_MS step
+void stepSimulation(Simulation *sim) {
+    const Uint32 SPAWN_INTERVAL = 500; // Spawn a vehicle every 500ms of simulated time
+    VehicleStore *store = &sim->store;
+
+    simClockTick(&sim->clock);
+
+    // Drain a batch of generated vehicles per step; anything left stays in
+    // the channel so the generator sees backpressure
+    if (sim->useChannel) {
+        Vehicle arrivals[VEHICLE_CHANNEL_BATCH];
+        VehicleHandle spawned[VEHICLE_CHANNEL_BATCH];
+        int spawnedCount = 0;
+        int arrivalCount = drainVehicleRecords(&sim->channel, arrivals, VEHICLE_CHANNEL_BATCH);
+        for (int a = 0; a < arrivalCount; a++) {
+            VehicleHandle handle = vehicleStoreSpawn(store, &arrivals[a]);
+            if (handle == INVALID_VEHICLE_HANDLE) {
+                fprintf(stderr, "Vehicle store is full, dropping vehicle\n");
+                continue;
+            }
+            spawned[spawnedCount++] = handle;
+            sim->vehicleCount++;
+            sim->stats.totalVehicles++;
+        }
+        queueArrivals(store, spawned, spawnedCount);
+
+        // Spawn locally again once the generator has gone away
+        if (sim->clock.now - sim->lastChannelCheck >= CHANNEL_CHECK_INTERVAL_MS) {
+            sim->lastChannelCheck = sim->clock.now;
+            if (!vehicleChannelProducerAlive(&sim->channel)) {
+                fprintf(stderr, "Vehicle generator stopped, spawning vehicles locally\n");
+                closeVehicleChannel(&sim->channel);
+                sim->useChannel = false;
+            }
+        }
+    }
+
+    // Spawn new vehicles periodically
+    Uint32 currentTime = sim->clock.now;
+    if (!sim->useChannel && currentTime - sim->lastVehicleSpawn >= SPAWN_INTERVAL) {
+        Direction spawnDirection = (Direction)(rand() % 4);
+        Vehicle* newVehicle = createVehicle(spawnDirection);
+        newVehicle->active = true;
+
+        VehicleHandle handle = vehicleStoreSpawn(store, newVehicle);
+        if (handle != INVALID_VEHICLE_HANDLE) {
+            queueArrival(store, handle);
+            sim->vehicleCount++;
+            sim->stats.totalVehicles++;
         } else {
-            vehicle.rect.w = 30;
-            vehicle.rect.h = 20;
+            fprintf(stderr, "Vehicle store is full, dropping vehicle\n");
         }
-        
-        vehicle.rect.x = (int)vehicle.x;
-        vehicle.rect.y = (int)vehicle.y;
+
+        free(newVehicle);
+        sim->lastVehicleSpawn = currentTime;
     }
-    return vehicle;
+
+    // Vehicles about to reach the intersection box enter only if the cells
+    // of their crossing are free when they will need them; the others only
+    // move up to its edge
+    admitVehicles(&sim->reservations, store);
+
+    // Move vehicles at the speeds the driver model set last step; the store
+    // keeps the awake ones packed in [0, awakeCount). Straight-through vehicles go
+    // through the SIMD batch kernel, turning ones through the full
+    // per-vehicle update, split across the update pool when --threads is
+    // given. Vehicles that left are swap-removed afterwards on this thread,
+    // so the result matches the serial path.
+    updateActiveVehicles(sim->updatePool, store);
+
+    // Keep every vehicle behind the one ahead of it in its lane, then pick
+    // next step's speeds from the gaps ahead and the lights. Vehicles that
+    // can only wait for a green light are parked until it comes.
+    if (updateLaneOrder(&sim->laneOrder, store)) {
+        applyCarFollowing(&sim->laneOrder, store);
+        if (applyDriverModel(&sim->idm, &sim->laneOrder, store, sim->lights)) {
+            parkStoppedVehicles(&sim->waitLists, &sim->laneOrder, store, sim->lights);
+        } else {
+            fprintf(stderr, "Out of memory gathering leader gaps, keeping speeds\n");
+        }
+    } else {
+        fprintf(stderr, "Out of memory ordering lanes, skipping car following\n");
+    }
+
+    // Count vehicles overlapping each other in the intersection box
+    if (buildConflictGrid(&sim->conflictGrid, store)) {
+        sim->stats.conflicts += countConflicts(&sim->conflictGrid, store);
+    }
+
+    releasePriorityEntries(store);
+
+    for (int i = 0; i < store->awakeCount; ) {
+        if (store->active[i]) {
+            i++;
+            continue;
+        }
+
+        // Vehicle has passed through the intersection: swap-remove it from
+        // the active range, which moves another awake vehicle into slot i
+        sim->stats.vehiclesPassed++;
+        sim->vehicleCount--;
+        VehicleHandle handle = vehicleStoreHandle(store, i);
+        bool queued = store->inLaneQueue[i];
+        vehicleStoreDeactivate(store, i);
+        if (!queued) {
+            vehicleStoreRelease(store, handle);
+        }
+    }
+
+    releaseCrossedVehicles(store);
+
+    // Update traffic lights and wake the vehicles waiting on those that
+    // turned green
+    unsigned int turnedGreen = updateTrafficLights(sim->lights, currentTime);
+    wakeWaitingVehicles(&sim->waitLists, store, turnedGreen);
+    advanceReservationTable(&sim->reservations);
+
+    // Update statistics
+    float minutes = (currentTime - sim->stats.startTime) / 60000.0f;
+    if (minutes > 0) {
+        sim->stats.vehiclesPerMinute = sim->stats.vehiclesPassed / minutes;
+    }
+}
+
+// Step until the simulated clock reaches durationMs, with no window and no
+// frame delay, then print a summary
+void runHeadless(Simulation *sim, Uint32 durationMs) {
+    clock_t cpuStart = clock();
+    while (sim->clock.now < durationMs) {
+        stepSimulation(sim);
+    }
+    double cpuSeconds = (double)(clock() - cpuStart) / CLOCKS_PER_SEC;
+
+    printf("Simulated time:       %.1f s (%u steps)\n", sim->clock.now / 1000.0, sim->clock.now / SIM_TICK_MS);
+    printf("Vehicles spawned:     %d\n", sim->stats.totalVehicles);
+    printf("Vehicles passed:      %d\n", sim->stats.vehiclesPassed);
+    printf("Vehicles on the road: %d\n", sim->vehicleCount);
+    printf("Vehicles per minute:  %.2f\n", sim->stats.vehiclesPerMinute);
+    printf("Conflicts:            %d (overlapping pairs in the intersection, summed over steps)\n", sim->stats.conflicts);
+    printf("CPU time:             %.3f s\n", cpuSeconds);
 }
+
 int main(int argc, char *argv[]) {
+#ifdef SIM_HEADLESS
+    bool headless = true;
+#else
     SDL_Window *window = NULL;
     SDL_Renderer *renderer = NULL;
     bool running = true;
-    Uint32 lastVehicleSpawn = 0;
-    const Uint32 SPAWN_INTERVAL = 500; // Spawn a vehicle every 500ms
+    bool headless = false;
+#endif
+    Uint32 durationMs = HEADLESS_DEFAULT_DURATION_MS;
+    int updateThreads = 1;
+    float speed = 1.0f;
+    unsigned int seed = (unsigned int)time(NULL);
+    bool channelRequested = false;
 
-    srand(time(NULL));
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            updateThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            // Simulated seconds per real second; "max" runs as fast as possible
+            i++;
+            speed = strcmp(argv[i], "max") == 0 ? 0.0f : (float)atof(argv[i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            // Simulated seconds a headless run lasts
+            durationMs = (Uint32)(atof(argv[++i]) * 1000.0);
+        } else if (strcmp(argv[i], "--channel") == 0) {
+            // Headless runs only take vehicles from GeneratorApp when asked to
+            channelRequested = true;
+        }
+    }
+
+    srand(seed);
+
+#ifndef SIM_HEADLESS
+    if (!headless) {
+        initializeSDL(&window, &renderer);
+    }
+#endif
 
-    initializeSDL(&window, &renderer);
+    Simulation sim = {0};
 
     // Initialize vehicles
-    Vehicle vehicles[MAX_VEHICLES] = {0};
-    int vehicleCount = 0;
+    if (!initVehicleStore(&sim.store, VEHICLE_STORE_INITIAL_CAPACITY)) {
+        fprintf(stderr, "Failed to allocate vehicle store\n");
+#ifndef SIM_HEADLESS
+        if (!headless) {
+            cleanupSDL(window, renderer);
+        }
+#endif
+        return 1;
+    }
+    sim.vehicleCount = 0;
+    sim.lastVehicleSpawn = 0;
+    initLaneOrder(&sim.laneOrder);
+    initIdmInputs(&sim.idm);
+    initWaitLists(&sim.waitLists);
+    initConflictGrid(&sim.conflictGrid);
+    initReservationTable(&sim.reservations);
+
+    sim.updatePool = NULL;
+    if (updateThreads > 1) {
+#ifdef SIM_HAVE_THREADS
+        sim.updatePool = createUpdatePool(updateThreads);
+        if (sim.updatePool == NULL) {
+            fprintf(stderr, "Failed to start update threads, updating serially\n");
+        }
+#else
+        fprintf(stderr, "--threads is not supported by this build (no threads without SDL on Windows), updating serially\n");
+#endif
+    }
 
     // Initialize traffic lights
-    TrafficLight lights[4];
-    initializeTrafficLights(lights);
+    initializeTrafficLights(sim.lights);
+    initializeTurnPaths();
+    initializeCrossingPaths();
 
-    // Initialize statistics
-    Statistics stats = {
+    // Initialize statistics; times are simulated milliseconds
+    sim.stats = (Statistics){
         .vehiclesPassed = 0,
         .totalVehicles = 0,
         .vehiclesPerMinute = 0,
-        .startTime = SDL_GetTicks()
+        .conflicts = 0,
+        .startTime = 0
     };
-     // Initialize queues
-     for (int i = 0; i < 4; i++) {
-        initQueue(&laneQueues[i]);
+     // Initialize queues; one that could not allocate starts empty and
+     // grows on its first enqueue, so the run can carry on
+     bool queuesReady = true;
+     for (int i = 0; i < LANE_QUEUE_COUNT; i++) {
+        queuesReady = initQueue(&laneQueues[i]) && queuesReady;
+    }
+    for (int i = 0; i < 4; i++) {
+        queuesReady = initPriorityQueue(&priorityLaneQueues[i]) && queuesReady;
+    }
+    if (!queuesReady) {
+        fprintf(stderr, "Failed to allocate lane queues, growing them on demand\n");
+    }
+
+    // Take vehicles from GeneratorApp when it is running, otherwise spawn
+    // locally. Headless runs spawn locally unless --channel is given, so a
+    // --seed run does not depend on whether a generator happens to be up.
+    sim.useChannel = (!headless || channelRequested) && openVehicleChannel(&sim.channel, false);
+
+    if (headless) {
+        // Headless runs never wait for real time, whatever --speed says
+        (void)speed;
+        initSimClock(&sim.clock, 0.0f, 0);
+        runHeadless(&sim, durationMs);
+    }
+#ifndef SIM_HEADLESS
+    else {
+        initSimClock(&sim.clock, speed, SDL_GetTicks());
     }
 
-    while (running) {
+    while (!headless && running) {
         handleEvents(&running);
 
-        // Spawn new vehicles periodically
-        Uint32 currentTime = SDL_GetTicks();
-        if (currentTime - lastVehicleSpawn >= SPAWN_INTERVAL && vehicleCount < MAX_VEHICLES) {
-            Direction spawnDirection = (Direction)(rand() % 4);
-            Vehicle* newVehicle = createVehicle(spawnDirection);
-            
-            // Find empty slot for new vehicle
-            for (int i = 0; i < MAX_VEHICLES; i++) {
-                if (!vehicles[i].active) {
-                    vehicles[i] = *newVehicle;
-                    vehicles[i].active = true;
-                    vehicleCount++;
-                    stats.totalVehicles++;
-                    break;
-                }
-            }
-            
-            free(newVehicle);
-            lastVehicleSpawn = currentTime;
-        }
-         // Update vehicles
-         for (int i = 0; i < MAX_VEHICLES; i++) {
-            if (vehicles[i].active) {
-                updateVehicle(&vehicles[i], lights);
-
-                // Check if vehicle has passed through intersection
-                if (!vehicles[i].active) {
-                    stats.vehiclesPassed++;
-                    vehicleCount--;
-                }
+        // Run the fixed steps that real time (scaled by --speed) has paid for.
+        // Unthrottled runs step until one frame's worth of real time is used.
+        Uint32 frameStart = SDL_GetTicks();
+        int steps = simClockStepsDue(&sim.clock, frameStart);
+        for (int s = 0; s < steps; s++) {
+            stepSimulation(&sim);
+            if (simClockUnthrottled(&sim.clock) && SDL_GetTicks() - frameStart >= SIM_TICK_MS) {
+                break;
             }
         }
 
-        // Update traffic lights
-        updateTrafficLights(lights);
+        renderSimulation(renderer, &sim.store, sim.lights, &sim.stats);
 
-        // Update statistics
-        float minutes = (SDL_GetTicks() - stats.startTime) / 60000.0f;
-        if (minutes > 0) {
-            stats.vehiclesPerMinute = stats.vehiclesPassed / minutes;
+        if (!simClockUnthrottled(&sim.clock)) {
+            SDL_Delay(SIM_TICK_MS); // Cap at ~60 FPS
         }
-
-        renderSimulation(renderer, vehicles, lights, &stats);
-
-        SDL_Delay(16); // Cap at ~60 FPS
     }
+#endif
+    for (int i = 0; i < LANE_QUEUE_COUNT; i++) {
+        destroyQueue(&laneQueues[i]);
+    }
+    for (int i = 0; i < 4; i++) {
+        destroyPriorityQueue(&priorityLaneQueues[i]);
+    }
+    freeQueueNodePool();
+    destroyUpdatePool(sim.updatePool);
+    freeConflictGrid(&sim.conflictGrid);
+    freeWaitLists(&sim.waitLists);
+    freeIdmInputs(&sim.idm);
+    freeLaneOrder(&sim.laneOrder);
+    freeVehicleStore(&sim.store);
+    closeVehicleChannel(&sim.channel);
+
     //cleaning up window and renderer frr
 
-    cleanupSDL(window, renderer);
+#ifndef SIM_HEADLESS
+    if (!headless) {
+        cleanupSDL(window, renderer);
+    }
+#endif
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include <stdlib.h>
+#include "traffic_simulation.h"
+
+// SDL's atomics take non-const pointers; the consumer-side readers below only load
+#define ATOMIC_LOAD(atomic) SDL_AtomicGet((SDL_atomic_t *)&(atomic))
+
+bool initMpscQueue(MpscQueue *q, unsigned int capacity)
+{
+    unsigned int rounded = 1;
+    while (rounded < capacity)
+    {
+        rounded <<= 1;
+    }
+    q->slots = (MpscSlot *)calloc(rounded, sizeof(MpscSlot));
+    q->capacity = q->slots != NULL ? rounded : 0;
+    SDL_AtomicSet(&q->tail, 0);
+    SDL_AtomicSet(&q->head, 0);
+    return q->slots != NULL;
+}
+
+void freeMpscQueue(MpscQueue *q)
+{
+    free(q->slots);
+    q->slots = NULL;
+    q->capacity = 0;
+    SDL_AtomicSet(&q->tail, 0);
+    SDL_AtomicSet(&q->head, 0);
+}
+
+// Claim up to count consecutive positions with one CAS; returns how many
+static int claimPositions(MpscQueue *q, int count, unsigned int *first)
+{
+    for (;;)
+    {
+        unsigned int position = (unsigned int)SDL_AtomicGet(&q->tail);
+        // head only moves forward, so a stale read can only under-report room
+        unsigned int room = q->capacity - (position - (unsigned int)SDL_AtomicGet(&q->head));
+        int claimed = (unsigned int)count < room ? count : (int)room;
+        if (claimed <= 0)
+        {
+            return 0;
+        }
+        if (SDL_AtomicCAS(&q->tail, (int)position, (int)(position + (unsigned int)claimed)))
+        {
+            *first = position;
+            return claimed;
+        }
+    }
+}
+
+static void publish(MpscQueue *q, unsigned int position, VehicleHandle handle)
+{
+    MpscSlot *slot = &q->slots[position & (q->capacity - 1)];
+    slot->handle = handle;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&slot->sequence, (int)(position + 1));
+}
+
+bool mpscEnqueue(MpscQueue *q, VehicleHandle handle, unsigned int *position)
+{
+    return mpscEnqueueN(q, &handle, 1, position) == 1;
+}
+
+int mpscEnqueueN(MpscQueue *q, const VehicleHandle *handles, int count, unsigned int *position)
+{
+    unsigned int first;
+    int claimed = claimPositions(q, count, &first);
+    for (int i = 0; i < claimed; i++)
+    {
+        publish(q, first + (unsigned int)i, handles[i]);
+    }
+    if (claimed > 0 && position != NULL)
+    {
+        *position = first;
+    }
+    return claimed;
+}
+
+VehicleHandle mpscPeek(const MpscQueue *q, unsigned int position)
+{
+    if (q->capacity == 0)
+    {
+        return INVALID_VEHICLE_HANDLE;
+    }
+    const MpscSlot *slot = &q->slots[position & (q->capacity - 1)];
+    // Stop at a slot still being written (or not claimed yet)
+    if ((unsigned int)ATOMIC_LOAD(slot->sequence) != position + 1)
+    {
+        return INVALID_VEHICLE_HANDLE;
+    }
+    SDL_MemoryBarrierAcquire();
+    return slot->handle;
+}
+
+unsigned int mpscHead(const MpscQueue *q)
+{
+    return (unsigned int)ATOMIC_LOAD(q->head);
+}
+
+int mpscDrain(MpscQueue *q, VehicleHandle *out, int maxCount)
+{
+    unsigned int head = mpscHead(q);
+    int count = 0;
+    while (count < maxCount)
+    {
+        VehicleHandle handle = mpscPeek(q, head);
+        if (handle == INVALID_VEHICLE_HANDLE)
+        {
+            break;
+        }
+        out[count++] = handle;
+        head++;
+    }
+
+    if (count > 0)
+    {
+        SDL_AtomicSet(&q->head, (int)head);
+    }
+    return count;
+}
+
+int mpscQueueSize(const MpscQueue *q)
+{
+    return (int)((unsigned int)ATOMIC_LOAD(q->tail) - mpscHead(q));
+}
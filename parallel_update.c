@@ -0,0 +1,199 @@
+#include <stdlib.h>
+#include "parallel_update.h"
+#include "vehicle_kernels.h"
+
+void updateVehicleRange(VehicleStore *store, int begin, int end)
+{
+    updateStraightVehicles(store, begin, end);
+    for (int i = begin; i < end; i++)
+    {
+        if (store->active[i] && store->turnDirection[i] != TURN_NONE)
+        {
+            updateVehicleRef(vehicleStoreRef(store, i));
+        }
+    }
+}
+
+#ifndef SIM_HAVE_THREADS
+// Headless Windows builds have no threads (sim_platform.h), so there is never
+// a pool and the update always runs on the calling thread
+UpdatePool *createUpdatePool(int threadCount)
+{
+    (void)threadCount;
+    return NULL;
+}
+
+void destroyUpdatePool(UpdatePool *pool)
+{
+    (void)pool;
+}
+
+int updatePoolThreadCount(const UpdatePool *pool)
+{
+    (void)pool;
+    return 1;
+}
+
+void updateActiveVehicles(UpdatePool *pool, VehicleStore *store)
+{
+    (void)pool;
+    updateVehicleRange(store, 0, store->awakeCount);
+}
+#else
+typedef struct {
+    UpdatePool* pool;
+    int index;
+    SDL_Thread* thread;
+    SDL_sem* start;
+} UpdateWorker;
+
+struct UpdatePool {
+    int threadCount;
+    UpdateWorker* workers;  // workers[0] is the calling thread and has no SDL_Thread
+    SDL_sem* done;          // posted once per finished worker chunk
+    bool quit;
+
+    // Current job, written before the start semaphores are posted
+    VehicleStore* store;
+    int chunkSize;
+};
+
+// Chunk [begin, end) for a worker; trailing workers get an empty range when
+// there are fewer chunks than threads
+static void runChunk(UpdatePool *pool, int index)
+{
+    int count = pool->store->awakeCount;
+    int begin = index * pool->chunkSize;
+    int end = begin + pool->chunkSize;
+    if (begin > count)
+    {
+        begin = count;
+    }
+    if (end > count)
+    {
+        end = count;
+    }
+    updateVehicleRange(pool->store, begin, end);
+}
+
+static int updateWorkerThread(void *data)
+{
+    UpdateWorker *worker = (UpdateWorker *)data;
+    UpdatePool *pool = worker->pool;
+    for (;;)
+    {
+        SDL_SemWait(worker->start);
+        if (pool->quit)
+        {
+            break;
+        }
+        runChunk(pool, worker->index);
+        SDL_SemPost(pool->done);
+    }
+    return 0;
+}
+
+UpdatePool *createUpdatePool(int threadCount)
+{
+    if (threadCount < 1)
+    {
+        threadCount = 1;
+    }
+    // Pick the batch kernel now; its lazy selection is not thread-safe
+    activeVehicleKernel();
+
+    UpdatePool *pool = (UpdatePool *)calloc(1, sizeof(UpdatePool));
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+    pool->workers = (UpdateWorker *)calloc((size_t)threadCount, sizeof(UpdateWorker));
+    pool->done = SDL_CreateSemaphore(0);
+    if (pool->workers == NULL || pool->done == NULL)
+    {
+        destroyUpdatePool(pool);
+        return NULL;
+    }
+
+    pool->workers[0].pool = pool;
+    pool->threadCount = 1;
+    for (int i = 1; i < threadCount; i++)
+    {
+        UpdateWorker *worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->index = i;
+        worker->start = SDL_CreateSemaphore(0);
+        if (worker->start == NULL)
+        {
+            destroyUpdatePool(pool);
+            return NULL;
+        }
+        worker->thread = SDL_CreateThread(updateWorkerThread, "VehicleUpdate", worker);
+        if (worker->thread == NULL)
+        {
+            SDL_DestroySemaphore(worker->start);
+            worker->start = NULL;
+            destroyUpdatePool(pool);
+            return NULL;
+        }
+        pool->threadCount++;
+    }
+    return pool;
+}
+
+void destroyUpdatePool(UpdatePool *pool)
+{
+    if (pool == NULL)
+    {
+        return;
+    }
+    pool->quit = true;
+    if (pool->workers != NULL)
+    {
+        for (int i = 1; i < pool->threadCount; i++)
+        {
+            SDL_SemPost(pool->workers[i].start);
+            SDL_WaitThread(pool->workers[i].thread, NULL);
+            SDL_DestroySemaphore(pool->workers[i].start);
+        }
+        free(pool->workers);
+    }
+    if (pool->done != NULL)
+    {
+        SDL_DestroySemaphore(pool->done);
+    }
+    free(pool);
+}
+
+int updatePoolThreadCount(const UpdatePool *pool)
+{
+    return pool != NULL ? pool->threadCount : 1;
+}
+
+void updateActiveVehicles(UpdatePool *pool, VehicleStore *store)
+{
+    int count = store->awakeCount;
+    if (pool == NULL || pool->threadCount == 1 || count < PARALLEL_UPDATE_MIN_VEHICLES)
+    {
+        updateVehicleRange(store, 0, count);
+        return;
+    }
+
+    int chunkSize = (count + pool->threadCount - 1) / pool->threadCount;
+    chunkSize = (chunkSize + PARALLEL_UPDATE_CHUNK_ALIGN - 1) / PARALLEL_UPDATE_CHUNK_ALIGN * PARALLEL_UPDATE_CHUNK_ALIGN;
+
+    pool->store = store;
+    pool->chunkSize = chunkSize;
+    for (int i = 1; i < pool->threadCount; i++)
+    {
+        SDL_SemPost(pool->workers[i].start);
+    }
+    runChunk(pool, 0);
+
+    // Barrier: every worker posts done exactly once per job
+    for (int i = 1; i < pool->threadCount; i++)
+    {
+        SDL_SemWait(pool->done);
+    }
+}
+#endif
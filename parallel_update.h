@@ -0,0 +1,40 @@
+#ifndef PARALLEL_UPDATE_H
+#define PARALLEL_UPDATE_H
+
+#include "traffic_simulation.h"
+#include "vehicle_store.h"
+
+// Below this many active vehicles the pool runs the update on the calling
+// thread; waking workers would cost more than it saves
+#define PARALLEL_UPDATE_MIN_VEHICLES 4096
+// Chunk boundaries are rounded to this many entries so no two threads write
+// the same cache line of any field array
+#define PARALLEL_UPDATE_CHUNK_ALIGN 64
+
+// Fixed pool of worker threads for the per-tick vehicle update. The awake
+// range [0, awakeCount) is cut into one contiguous chunk per thread and every
+// chunk runs the same update as the serial path. A vehicle's move only reads
+// its own fields (speeds are set beforehand by the driver model, idm.h), so
+// chunks never touch each other's entries and the result is identical to the
+// serial path.
+//
+// Workers only flag vehicles that left (active = false); swap-removing them
+// and counting vehiclesPassed stays with the caller, after the update returns,
+// so statistics and dense order do not depend on thread timing.
+typedef struct UpdatePool UpdatePool;
+
+// threadCount includes the calling thread, which always takes the first
+// chunk. Returns NULL if the threads could not be started, and always in
+// builds without SIM_HAVE_THREADS (headless Windows builds).
+UpdatePool* createUpdatePool(int threadCount);
+void destroyUpdatePool(UpdatePool* pool);
+int updatePoolThreadCount(const UpdatePool* pool);
+
+// Update the active vehicles in [begin, end): straight ones through the batch
+// kernel, turning ones through updateVehicleRef
+void updateVehicleRange(VehicleStore* store, int begin, int end);
+// Update the whole awake range, split across the pool (NULL runs serially).
+// Returns once every chunk is done, so the caller can update the lights next.
+void updateActiveVehicles(UpdatePool* pool, VehicleStore* store);
+
+#endif
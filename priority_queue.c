@@ -0,0 +1,139 @@
+#include "priority_queue.h"
+#include "vehicle_store.h"
+
+// Marks an entry removed out of order; the store never hands out this slot
+#define REMOVED_ENTRY MAKE_VEHICLE_HANDLE(VEHICLE_STORE_MAX_CAPACITY, 0)
+
+PriorityQueue priorityLaneQueues[4];
+
+// Emergency vehicles outrank regular traffic; ambulances outrank everything
+static const int TYPE_PRIORITY[] = {
+    0, // REGULAR_CAR
+    3, // AMBULANCE
+    1, // POLICE_CAR
+    2  // FIRE_TRUCK
+};
+
+static const VehicleType PRIORITY_TYPE[PRIORITY_CLASS_COUNT] = {
+    REGULAR_CAR,
+    POLICE_CAR,
+    FIRE_TRUCK,
+    AMBULANCE
+};
+
+// Highest set bit of a 4-bit class mask (-1 when empty)
+static const int HIGHEST_CLASS[1 << PRIORITY_CLASS_COUNT] = {
+    -1, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3
+};
+
+int vehiclePriority(VehicleType type)
+{
+    return TYPE_PRIORITY[type];
+}
+
+bool initPriorityQueue(PriorityQueue *pq)
+{
+    bool ok = true;
+    for (int p = 0; p < PRIORITY_CLASS_COUNT; p++)
+    {
+        ok = initQueue(&pq->classes[p]) && ok;
+        pq->classSizes[p] = 0;
+    }
+    pq->nonEmptyMask = 0;
+    pq->size = 0;
+    return ok;
+}
+
+void destroyPriorityQueue(PriorityQueue *pq)
+{
+    for (int p = 0; p < PRIORITY_CLASS_COUNT; p++)
+    {
+        destroyQueue(&pq->classes[p]);
+        pq->classSizes[p] = 0;
+    }
+    pq->nonEmptyMask = 0;
+    pq->size = 0;
+}
+
+bool priorityEnqueue(PriorityQueue *pq, VehicleHandle handle, VehicleType type, unsigned int *ticket)
+{
+    int p = TYPE_PRIORITY[type];
+    if (!enqueue(&pq->classes[p], handle, ticket))
+    {
+        return false;
+    }
+    pq->classSizes[p]++;
+    pq->nonEmptyMask |= 1u << p;
+    pq->size++;
+    return true;
+}
+
+// Account for one live entry of class p leaving, then drop the tombstones it
+// uncovered so the front of every class is always a live vehicle
+static void removedFromClass(PriorityQueue *pq, int p)
+{
+    pq->classSizes[p]--;
+    pq->size--;
+    if (pq->classSizes[p] == 0)
+    {
+        pq->nonEmptyMask &= ~(1u << p);
+    }
+    while (!isQueueEmpty(&pq->classes[p]) && queueFront(&pq->classes[p]) == REMOVED_ENTRY)
+    {
+        dequeue(&pq->classes[p]);
+    }
+}
+
+VehicleHandle priorityDequeueType(PriorityQueue *pq, VehicleType type)
+{
+    int p = TYPE_PRIORITY[type];
+    if (!(pq->nonEmptyMask & (1u << p)))
+    {
+        return INVALID_VEHICLE_HANDLE;
+    }
+    VehicleHandle handle = dequeue(&pq->classes[p]);
+    removedFromClass(pq, p);
+    return handle;
+}
+
+bool priorityRemove(PriorityQueue *pq, VehicleType type, unsigned int ticket)
+{
+    int p = TYPE_PRIORITY[type];
+    Queue *q = &pq->classes[p];
+    if (queuePositionOf(q, ticket) == 0 && !isQueueEmpty(q))
+    {
+        dequeue(q);
+    }
+    else if (queuePeekAt(q, queuePositionOf(q, ticket)) == REMOVED_ENTRY || !queueReplace(q, ticket, REMOVED_ENTRY))
+    {
+        return false;
+    }
+    removedFromClass(pq, p);
+    return true;
+}
+
+VehicleHandle priorityDequeue(PriorityQueue *pq)
+{
+    int p = HIGHEST_CLASS[pq->nonEmptyMask];
+    if (p < 0)
+    {
+        return INVALID_VEHICLE_HANDLE;
+    }
+    return priorityDequeueType(pq, PRIORITY_TYPE[p]);
+}
+
+bool highestWaitingType(PriorityQueue *pq, VehicleType *type)
+{
+    int p = HIGHEST_CLASS[pq->nonEmptyMask];
+    if (p < 0)
+    {
+        return false;
+    }
+    *type = PRIORITY_TYPE[p];
+    return true;
+}
+
+int isPriorityQueueEmpty(PriorityQueue *pq)
+{
+    return pq->size == 0;
+}
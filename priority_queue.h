@@ -0,0 +1,37 @@
+#ifndef PRIORITY_QUEUE_H
+#define PRIORITY_QUEUE_H
+
+#include <stdbool.h>
+#include "traffic_simulation.h"
+
+// Bucket queue with one FIFO per VehicleType priority class. A bitmask of
+// non-empty classes makes enqueue, dequeue-highest and peek-highest O(1)
+// while keeping arrival order within a class. A vehicle that leaves out of
+// order is removed by the ticket priorityEnqueue gave it: its entry becomes a
+// tombstone that is skipped once it reaches the front of its class.
+#define PRIORITY_CLASS_COUNT 4
+
+typedef struct {
+    Queue classes[PRIORITY_CLASS_COUNT]; // indexed by priority, 0 = lowest
+    int classSizes[PRIORITY_CLASS_COUNT]; // live entries, without tombstones
+    unsigned int nonEmptyMask;           // bit p set while classes[p] holds live vehicles
+    int size;
+} PriorityQueue;
+
+// Waiting vehicles per approach, grouped by priority class
+extern PriorityQueue priorityLaneQueues[4];
+
+int vehiclePriority(VehicleType type);
+
+bool initPriorityQueue(PriorityQueue* pq); // false if a class queue could not be allocated
+void destroyPriorityQueue(PriorityQueue* pq);
+// false if the handle could not be queued; *ticket (may be NULL) is for priorityRemove
+bool priorityEnqueue(PriorityQueue* pq, VehicleHandle handle, VehicleType type, unsigned int* ticket);
+VehicleHandle priorityDequeue(PriorityQueue* pq);                    // oldest of the highest class
+VehicleHandle priorityDequeueType(PriorityQueue* pq, VehicleType type); // oldest of one class
+// Remove the entry priorityEnqueue returned ticket for; false if it is gone already
+bool priorityRemove(PriorityQueue* pq, VehicleType type, unsigned int ticket);
+bool highestWaitingType(PriorityQueue* pq, VehicleType* type);
+int isPriorityQueueEmpty(PriorityQueue* pq);
+
+#endif
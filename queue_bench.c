@@ -0,0 +1,470 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+#include "traffic_simulation.h"
+#include "priority_queue.h"
+
+// Queue micro-benchmark. Prints one CSV row per (backend, workload):
+//   backend,workload,ops,seconds,ops_per_sec,p50_ns,p90_ns,p99_ns,p999_ns
+// Latency is sampled per batch of LATENCY_BATCH operations so timer overhead
+// does not swamp the sub-100ns queue operations; the reported figures are
+// per operation. ops counts pushes and pops alike in every workload; the
+// threaded workload samples the pushes of all producers.
+#define DEFAULT_OPS 1000000
+#define LATENCY_BATCH 32
+#define STEADY_DEPTH 64
+#define BURST_SIZE 256
+#define PRODUCER_COUNT 2
+#define TYPE_TABLE_SIZE 4096 // power of two
+
+// Vehicle type per handle, consulted by the priority backend
+static VehicleType handleTypes[TYPE_TABLE_SIZE];
+
+// Uniform view of each backend so every workload runs the same code path
+typedef struct {
+    const char *name;
+    void *(*create)(void);
+    void (*destroy)(void *queue);
+    bool (*push)(void *queue, VehicleHandle handle);
+    bool (*pop)(void *queue, VehicleHandle *handle);
+    int (*pushN)(void *queue, const VehicleHandle *handles, int count);
+    int (*popN)(void *queue, VehicleHandle *out, int maxCount);
+    bool threadSafe; // producers may push concurrently without a lock
+} QueueBackend;
+
+// Pooled linked-list Queue
+static void *listCreate(void)
+{
+    Queue *q = (Queue *)malloc(sizeof(Queue));
+    if (q == NULL || !initQueue(q))
+    {
+        free(q);
+        return NULL;
+    }
+    return q;
+}
+static void listDestroy(void *q) { destroyQueue((Queue *)q); free(q); }
+static bool listPush(void *q, VehicleHandle h) { return enqueue((Queue *)q, h, NULL); }
+static bool listPop(void *q, VehicleHandle *h)
+{
+    if (isQueueEmpty((Queue *)q))
+        return false;
+    *h = dequeue((Queue *)q);
+    return true;
+}
+static int listPushN(void *q, const VehicleHandle *h, int n) { return enqueueN((Queue *)q, h, n, NULL); }
+static int listPopN(void *q, VehicleHandle *out, int n) { return dequeueN((Queue *)q, out, n); }
+
+// Growable ring buffer
+static void *ringCreate(void)
+{
+    RingQueue *q = (RingQueue *)malloc(sizeof(RingQueue));
+    if (q == NULL || !initRingQueue(q, RING_QUEUE_DEFAULT_CAPACITY, true))
+    {
+        free(q);
+        return NULL;
+    }
+    return q;
+}
+static void ringDestroy(void *q) { freeRingQueue((RingQueue *)q); free(q); }
+static bool ringPush(void *q, VehicleHandle h) { return ringEnqueue((RingQueue *)q, h); }
+static bool ringPop(void *q, VehicleHandle *h)
+{
+    if (isRingQueueEmpty((RingQueue *)q))
+        return false;
+    *h = ringDequeue((RingQueue *)q);
+    return true;
+}
+static int ringPushN(void *q, const VehicleHandle *h, int n) { return ringEnqueueN((RingQueue *)q, h, n); }
+static int ringPopN(void *q, VehicleHandle *out, int n) { return ringDequeueN((RingQueue *)q, out, n); }
+
+// Bucket priority queue
+static void *priorityCreate(void)
+{
+    PriorityQueue *q = (PriorityQueue *)malloc(sizeof(PriorityQueue));
+    if (q == NULL || !initPriorityQueue(q))
+    {
+        if (q != NULL)
+        {
+            destroyPriorityQueue(q);
+        }
+        free(q);
+        return NULL;
+    }
+    return q;
+}
+static void priorityDestroy(void *q) { destroyPriorityQueue((PriorityQueue *)q); free(q); }
+static bool priorityPush(void *q, VehicleHandle h)
+{
+    return priorityEnqueue((PriorityQueue *)q, h, handleTypes[h & (TYPE_TABLE_SIZE - 1)], NULL);
+}
+static bool priorityPop(void *q, VehicleHandle *h)
+{
+    if (isPriorityQueueEmpty((PriorityQueue *)q))
+        return false;
+    *h = priorityDequeue((PriorityQueue *)q);
+    return true;
+}
+
+// Lock-free multi-producer queue
+static void *mpscCreate(void)
+{
+    MpscQueue *q = (MpscQueue *)malloc(sizeof(MpscQueue));
+    if (q == NULL || !initMpscQueue(q, MPSC_QUEUE_DEFAULT_CAPACITY))
+    {
+        free(q);
+        return NULL;
+    }
+    return q;
+}
+static void mpscDestroy(void *q) { freeMpscQueue((MpscQueue *)q); free(q); }
+static bool mpscPush(void *q, VehicleHandle h) { return mpscEnqueue((MpscQueue *)q, h, NULL); }
+static bool mpscPop(void *q, VehicleHandle *h) { return mpscDrain((MpscQueue *)q, h, 1) == 1; }
+static int mpscPushN(void *q, const VehicleHandle *h, int n) { return mpscEnqueueN((MpscQueue *)q, h, n, NULL); }
+static int mpscPopN(void *q, VehicleHandle *out, int n) { return mpscDrain((MpscQueue *)q, out, n); }
+
+static const QueueBackend BACKENDS[] = {
+    {"linked_list", listCreate, listDestroy, listPush, listPop, listPushN, listPopN, false},
+    {"ring_buffer", ringCreate, ringDestroy, ringPush, ringPop, ringPushN, ringPopN, false},
+    {"priority_bucket", priorityCreate, priorityDestroy, priorityPush, priorityPop, NULL, NULL, false},
+    {"mpsc_lock_free", mpscCreate, mpscDestroy, mpscPush, mpscPop, mpscPushN, mpscPopN, true},
+};
+#define BACKEND_COUNT (int)(sizeof(BACKENDS) / sizeof(BACKENDS[0]))
+
+typedef struct {
+    double *samples; // nanoseconds per operation, one per latency batch
+    int count;
+    int capacity;
+} LatencySamples;
+
+static double ticksToNs(Uint64 ticks)
+{
+    return (double)ticks * 1e9 / (double)SDL_GetPerformanceFrequency();
+}
+
+static void recordLatency(LatencySamples *latency, Uint64 ticks, int ops)
+{
+    if (latency->count < latency->capacity && ops > 0)
+    {
+        latency->samples[latency->count++] = ticksToNs(ticks) / ops;
+    }
+}
+
+static int compareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(LatencySamples *latency, double p)
+{
+    if (latency->count == 0)
+    {
+        return 0;
+    }
+    int index = (int)(p * (latency->count - 1));
+    return latency->samples[index];
+}
+
+static void printResult(const char *backend, const char *workload, long ops, Uint64 ticks, LatencySamples *latency)
+{
+    double seconds = ticksToNs(ticks) / 1e9;
+    qsort(latency->samples, latency->count, sizeof(double), compareDoubles);
+    printf("%s,%s,%ld,%.6f,%.0f,%.1f,%.1f,%.1f,%.1f\n",
+           backend, workload, ops, seconds, seconds > 0 ? ops / seconds : 0,
+           percentile(latency, 0.50), percentile(latency, 0.90),
+           percentile(latency, 0.99), percentile(latency, 0.999));
+    fflush(stdout);
+}
+
+// Regular cars only, or the same 85/5/5/5 mix createVehicle uses
+static void assignHandleTypes(bool mixedTypes)
+{
+    for (int i = 0; i < TYPE_TABLE_SIZE; i++)
+    {
+        int roll = mixedTypes ? rand() % 100 : 100;
+        handleTypes[i] = roll < 5 ? AMBULANCE : roll < 10 ? POLICE_CAR : roll < 15 ? FIRE_TRUCK : REGULAR_CAR;
+    }
+}
+
+// Constant depth: every push is matched by a pop
+static Uint64 runSteady(const QueueBackend *backend, void *q, long ops, LatencySamples *latency)
+{
+    VehicleHandle handle;
+    for (int i = 0; i < STEADY_DEPTH; i++)
+    {
+        backend->push(q, (VehicleHandle)i);
+    }
+
+    Uint64 total = 0;
+    for (long done = 0; done < ops; done += LATENCY_BATCH * 2)
+    {
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < LATENCY_BATCH; i++)
+        {
+            backend->push(q, (VehicleHandle)(done + i));
+            backend->pop(q, &handle);
+        }
+        Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+        total += elapsed;
+        recordLatency(latency, elapsed, LATENCY_BATCH * 2);
+    }
+
+    while (backend->pop(q, &handle))
+    {
+    }
+    return total;
+}
+
+// Fill with a burst, then drain it; uses the batch API when the backend has one
+static Uint64 runBursty(const QueueBackend *backend, void *q, long ops, LatencySamples *latency)
+{
+    VehicleHandle burst[BURST_SIZE];
+    Uint64 total = 0;
+    for (long done = 0; done < ops; done += BURST_SIZE * 2)
+    {
+        for (int i = 0; i < BURST_SIZE; i++)
+        {
+            burst[i] = (VehicleHandle)(done + i);
+        }
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        if (backend->pushN != NULL)
+        {
+            backend->pushN(q, burst, BURST_SIZE);
+        }
+        else
+        {
+            for (int i = 0; i < BURST_SIZE; i++)
+            {
+                backend->push(q, burst[i]);
+            }
+        }
+        if (backend->popN != NULL)
+        {
+            int drained = 0;
+            while (drained < BURST_SIZE)
+            {
+                int n = backend->popN(q, burst + drained, BURST_SIZE - drained);
+                if (n == 0)
+                    break;
+                drained += n;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < BURST_SIZE; i++)
+            {
+                backend->pop(q, &burst[i]);
+            }
+        }
+        Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+        total += elapsed;
+        recordLatency(latency, elapsed, BURST_SIZE * 2);
+    }
+    return total;
+}
+
+typedef struct {
+    const QueueBackend *backend;
+    void *queue;
+    SDL_mutex *lock; // NULL for lock-free backends
+    long count;
+    long firstIndex;
+    LatencySamples latency; // this producer's share of the sample buffer
+} ProducerArgs;
+
+static int producerThread(void *data)
+{
+    ProducerArgs *args = (ProducerArgs *)data;
+    long pushed = 0;
+    while (pushed < args->count)
+    {
+        int batch = args->count - pushed < LATENCY_BATCH ? (int)(args->count - pushed) : LATENCY_BATCH;
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < batch;)
+        {
+            VehicleHandle handle = (VehicleHandle)(args->firstIndex + pushed + i);
+            bool ok;
+            if (args->lock != NULL)
+            {
+                SDL_LockMutex(args->lock);
+                ok = args->backend->push(args->queue, handle);
+                SDL_UnlockMutex(args->lock);
+            }
+            else
+            {
+                ok = args->backend->push(args->queue, handle);
+            }
+            if (ok)
+            {
+                i++;
+            }
+            else
+            {
+                SDL_Delay(0); // queue full: let the consumer run
+            }
+        }
+        recordLatency(&args->latency, SDL_GetPerformanceCounter() - start, batch);
+        pushed += batch;
+    }
+    return 0;
+}
+
+// PRODUCER_COUNT threads push ops / 2 handles between them while this thread
+// drains; non-thread-safe backends are guarded by a mutex to give the locked
+// baseline. Returns false if the mutex or a producer thread could not be
+// created; the producers that did start are still drained and joined.
+static bool runThreaded(const QueueBackend *backend, void *q, long ops, LatencySamples *latency, Uint64 *ticks)
+{
+    SDL_mutex *lock = NULL;
+    if (!backend->threadSafe && (lock = SDL_CreateMutex()) == NULL)
+    {
+        fprintf(stderr, "Failed to create the queue lock: %s\n", SDL_GetError());
+        return false;
+    }
+    ProducerArgs args[PRODUCER_COUNT];
+    SDL_Thread *threads[PRODUCER_COUNT];
+    long perProducer = ops / 2 / PRODUCER_COUNT;
+    int sliceCapacity = latency->capacity / PRODUCER_COUNT;
+    VehicleHandle drained[BURST_SIZE];
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    int started = 0;
+    for (; started < PRODUCER_COUNT; started++)
+    {
+        LatencySamples slice = {latency->samples + started * sliceCapacity, 0, sliceCapacity};
+        args[started] = (ProducerArgs){backend, q, lock, perProducer, started * perProducer, slice};
+        threads[started] = SDL_CreateThread(producerThread, "QueueBenchProducer", &args[started]);
+        if (threads[started] == NULL)
+        {
+            fprintf(stderr, "Failed to start producer thread: %s\n", SDL_GetError());
+            break;
+        }
+    }
+
+    long consumed = 0;
+    while (consumed < perProducer * started)
+    {
+        if (lock != NULL)
+        {
+            SDL_LockMutex(lock);
+        }
+        int n;
+        if (backend->popN != NULL)
+        {
+            n = backend->popN(q, drained, BURST_SIZE);
+        }
+        else
+        {
+            n = backend->pop(q, &drained[0]) ? 1 : 0;
+        }
+        if (lock != NULL)
+        {
+            SDL_UnlockMutex(lock);
+        }
+        if (n == 0)
+        {
+            SDL_Delay(0); // nothing published yet: let the producers run
+        }
+        consumed += n;
+    }
+
+    for (int p = 0; p < started; p++)
+    {
+        SDL_WaitThread(threads[p], NULL);
+    }
+    *ticks = SDL_GetPerformanceCounter() - start;
+    if (lock != NULL)
+    {
+        SDL_DestroyMutex(lock);
+    }
+
+    // Pack the producers' samples together for the percentiles
+    latency->count = 0;
+    for (int p = 0; p < started; p++)
+    {
+        memmove(latency->samples + latency->count, args[p].latency.samples, args[p].latency.count * sizeof(double));
+        latency->count += args[p].latency.count;
+    }
+    return started == PRODUCER_COUNT;
+}
+
+int main(int argc, char *argv[])
+{
+    long ops = DEFAULT_OPS;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--ops") == 0 && i + 1 < argc)
+        {
+            ops = atol(argv[++i]);
+        }
+    }
+    // One latency sample per batch, counted in int
+    if (ops <= 0 || ops / LATENCY_BATCH >= INT_MAX)
+    {
+        fprintf(stderr, "--ops must be between 1 and %ld\n", (long)INT_MAX * LATENCY_BATCH - 1);
+        return 1;
+    }
+    LatencySamples latency;
+    latency.capacity = (int)(ops / LATENCY_BATCH) + 1;
+    latency.samples = (double *)malloc((size_t)latency.capacity * sizeof(double));
+    if (latency.samples == NULL)
+    {
+        fprintf(stderr, "Failed to allocate %d latency samples\n", latency.capacity);
+        return 1;
+    }
+
+    const char *workloads[] = {"steady_fifo", "bursty", "mixed_priority", "threaded_producer_consumer"};
+    printf("backend,workload,ops,seconds,ops_per_sec,p50_ns,p90_ns,p99_ns,p999_ns\n");
+
+    for (int b = 0; b < BACKEND_COUNT; b++)
+    {
+        const QueueBackend *backend = &BACKENDS[b];
+        for (int w = 0; w < 4; w++)
+        {
+            void *q = backend->create();
+            if (q == NULL)
+            {
+                fprintf(stderr, "Failed to allocate a %s queue, skipping %s\n", backend->name, workloads[w]);
+                continue;
+            }
+            latency.count = 0;
+            srand(1);
+            assignHandleTypes(w == 2);
+            Uint64 ticks = 0;
+            bool completed = true;
+            switch (w)
+            {
+            case 0:
+                ticks = runSteady(backend, q, ops, &latency);
+                break;
+            case 1:
+                ticks = runBursty(backend, q, ops, &latency);
+                break;
+            case 2:
+                ticks = runSteady(backend, q, ops, &latency);
+                break;
+            case 3:
+                completed = runThreaded(backend, q, ops, &latency, &ticks);
+                break;
+            }
+            if (completed)
+            {
+                printResult(backend->name, workloads[w], ops, ticks, &latency);
+            }
+            else
+            {
+                fprintf(stderr, "Skipping %s %s\n", backend->name, workloads[w]);
+            }
+            backend->destroy(q);
+        }
+    }
+
+    free(latency.samples);
+    freeQueueNodePool();
+    return 0;
+}
@@ -0,0 +1,215 @@
+#include <math.h>
+#include <string.h>
+#include "reservation.h"
+#include "car_following.h"
+
+CrossingPath crossingPaths[4][3][LANES_PER_DIRECTION];
+
+_Static_assert((RESERVATION_HORIZON & (RESERVATION_HORIZON - 1)) == 0, "RESERVATION_HORIZON must be a power of two");
+
+// Drive a reference vehicle from its spawn point through the box at
+// CROSSING_STEP per tick and record the cells it covers on every tick
+static void traceCrossing(CrossingPath *path, Direction direction, TurnDirection turn, int lane)
+{
+    const DirectionGeometry *geometry = &DIRECTION_GEOMETRY[direction];
+
+    // Spawn position and lane centre as createVehicle picks them
+    float lateral = (geometry->axis == AXIS_Y ? INTERSECTION_X : INTERSECTION_Y) - LANE_WIDTH / 2 +
+                    lane * LANE_WIDTH + (LANE_WIDTH / 4 - VEHICLE_WIDTH / 2);
+    float spawn = geometry->sign > 0 ? 0.0f
+                                     : (geometry->axis == AXIS_Y ? WINDOW_HEIGHT : WINDOW_WIDTH) - VEHICLE_LENGTH;
+
+    Vehicle vehicle = {0};
+    vehicle.x = geometry->axis == AXIS_Y ? lateral : spawn;
+    vehicle.y = geometry->axis == AXIS_Y ? spawn : lateral;
+    vehicle.type = REGULAR_CAR;
+    vehicle.direction = direction;
+    vehicle.turnDirection = turn;
+    vehicle.state = STATE_MOVING;
+    vehicle.speed = CROSSING_STEP;
+    vehicle.active = true;
+    vehicle.isInRightLane = lane == 1;
+
+    path->holdAdvance = alongLane(geometry, vehicle.x, vehicle.y);
+    path->sampleCount = 0;
+    bool entered = false;
+    while (vehicle.active && path->sampleCount < CROSSING_MAX_SAMPLES)
+    {
+        float before = alongLane(geometry, vehicle.x, vehicle.y);
+        updateVehicle(&vehicle);
+        SDL_Rect rect = vehicleRect(&vehicle);
+        uint64_t cells = footprintCellMask(&rect);
+        if (!entered)
+        {
+            if (cells == 0)
+            {
+                continue;
+            }
+            entered = true;
+            path->holdAdvance = before;
+        }
+        if (cells == 0)
+        {
+            break;
+        }
+        path->cells[path->sampleCount++] = cells;
+    }
+}
+
+void initializeCrossingPaths(void)
+{
+    for (int direction = 0; direction < 4; direction++)
+    {
+        for (int turn = TURN_NONE; turn <= TURN_RIGHT; turn++)
+        {
+            for (int lane = 0; lane < LANES_PER_DIRECTION; lane++)
+            {
+                traceCrossing(&crossingPaths[direction][turn][lane], (Direction)direction, (TurnDirection)turn, lane);
+            }
+        }
+    }
+}
+
+void initReservationTable(ReservationTable *table)
+{
+    memset(table, 0, sizeof(ReservationTable));
+}
+
+void advanceReservationTable(ReservationTable *table)
+{
+    table->slots[RESERVATION_SLOT(table->now)] = 0;
+    table->now++;
+}
+
+bool reserveCrossing(ReservationTable *table, const CrossingPath *path, float laneAdvance, float speed,
+                     const IdmParameters *params)
+{
+    // Cells needed per tick from now. The vehicle moves by speed on this
+    // tick, then speeds up as the driver model does inside the box (on a free
+    // road, see idm.h); on tick t it covers the samples between its position
+    // before and after that tick's move, widened by the slack.
+    uint64_t needed[RESERVATION_HORIZON] = {0};
+    int lastTick = -1;
+    float distance = laneAdvance - path->holdAdvance;
+    for (int t = 0;; t++)
+    {
+        if (t >= RESERVATION_HORIZON)
+        {
+            return false; // too slow to plan that far ahead
+        }
+        float nextDistance = distance + speed;
+        // Sample k is taken (k + 1) * CROSSING_STEP past the hold point; in
+        // between two samples the footprint covers cells of both
+        int first = (int)floorf(distance / CROSSING_STEP) - 1;
+        int last = (int)ceilf(nextDistance / CROSSING_STEP) - 1;
+        if (first >= path->sampleCount)
+        {
+            break;
+        }
+        if (last >= 0)
+        {
+            uint64_t cells = 0;
+            for (int k = first > 0 ? first : 0; k <= last && k < path->sampleCount; k++)
+            {
+                cells |= path->cells[k];
+            }
+            int until = t + RESERVATION_SLACK;
+            if (until >= RESERVATION_HORIZON)
+            {
+                return false;
+            }
+            for (int u = t > RESERVATION_SLACK ? t - RESERVATION_SLACK : 0; u <= until; u++)
+            {
+                needed[u] |= cells;
+            }
+            lastTick = until;
+        }
+        distance = nextDistance;
+        speed += idmAcceleration(params, speed, IDM_FREE_GAP, speed);
+    }
+
+    for (int t = 0; t <= lastTick; t++)
+    {
+        if (table->slots[RESERVATION_SLOT(table->now + t)] & needed[t])
+        {
+            return false;
+        }
+    }
+    for (int t = 0; t <= lastTick; t++)
+    {
+        table->slots[RESERVATION_SLOT(table->now + t)] |= needed[t];
+    }
+    return true;
+}
+
+static const CrossingPath *crossingPathOf(const VehicleStore *store, int index)
+{
+    return &crossingPaths[store->direction[index]][store->turnDirection[index]][store->isInRightLane[index] ? 1 : 0];
+}
+
+// Refused: this tick's move only takes the vehicle up to the edge of the box,
+// where it stops and asks again when the driver model pulls away. It is put
+// exactly on the hold point, as moving there by speed could round past it.
+static void holdAtEdge(VehicleStore *store, int index)
+{
+    setLaneAdvance(store, index, crossingPathOf(store, index)->holdAdvance);
+    store->speed[index] = 0;
+    store->state[index] = STATE_STOPPED;
+}
+
+int admitVehicles(ReservationTable *table, VehicleStore *store)
+{
+    // The vehicle about to enter from each lane. Lanes then ask in a fixed
+    // order rather than in dense order, which parking reshuffles, so the
+    // run is the same with or without parking.
+    int entering[LANE_QUEUE_COUNT];
+    for (int lane = 0; lane < LANE_QUEUE_COUNT; lane++)
+    {
+        entering[lane] = -1;
+    }
+
+    int held = 0;
+    for (int i = 0; i < store->awakeCount; i++)
+    {
+        if (!store->active[i] || (store->state[i] != STATE_MOVING && store->state[i] != STATE_STOPPING))
+        {
+            continue;
+        }
+
+        // Only vehicles whose move on this tick would take them into the box
+        float advance = laneAdvance(store, i);
+        float holdAdvance = crossingPathOf(store, i)->holdAdvance;
+        if (advance > holdAdvance || advance + store->speed[i] <= holdAdvance)
+        {
+            continue;
+        }
+
+        // Car following keeps two such vehicles of a lane apart; if they
+        // still meet, the one behind waits
+        int lane = laneQueueIndex((Direction)store->direction[i], store->isInRightLane[i]);
+        int behind = i;
+        if (entering[lane] < 0 || advance > laneAdvance(store, entering[lane]))
+        {
+            behind = entering[lane];
+            entering[lane] = i;
+        }
+        if (behind >= 0)
+        {
+            holdAtEdge(store, behind);
+            held++;
+        }
+    }
+
+    for (int lane = 0; lane < LANE_QUEUE_COUNT; lane++)
+    {
+        int i = entering[lane];
+        if (i < 0 || reserveCrossing(table, crossingPathOf(store, i), laneAdvance(store, i), store->speed[i],
+                                     &IDM_PARAMETERS[store->type[i]]))
+        {
+            continue;
+        }
+        holdAtEdge(store, i);
+        held++;
+    }
+    return held;
+}
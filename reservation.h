@@ -0,0 +1,61 @@
+#ifndef RESERVATION_H
+#define RESERVATION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "traffic_simulation.h"
+#include "vehicle_store.h"
+#include "conflict_grid.h"
+
+// Ticks ahead that can be reserved; a power of two so slots wrap with a mask
+#define RESERVATION_HORIZON 256
+#define RESERVATION_SLOT(tick) ((tick) & (RESERVATION_HORIZON - 1))
+// Extra ticks a cell stays reserved before and after a vehicle's planned
+// time there, to absorb small speed changes inside the box
+#define RESERVATION_SLACK 2
+// Distance between the samples of a crossing path
+#define CROSSING_STEP 2.0f
+#define CROSSING_MAX_SAMPLES 256
+
+// Cells of the CONFLICT_GRID over the intersection a vehicle's footprint
+// covers at evenly spaced distances along its way through the box, from the
+// first sample that touches the box until it is clear of it. Precomputed per
+// direction, turn and lane by driving a reference vehicle through with
+// updateVehicle, so the cells follow the same turning paths as the simulation.
+typedef struct {
+    float holdAdvance;  // furthest along the lane a vehicle can be without touching the box
+    int sampleCount;
+    uint64_t cells[CROSSING_MAX_SAMPLES]; // sample k is holdAdvance + (k + 1) * CROSSING_STEP along
+} CrossingPath;
+
+extern CrossingPath crossingPaths[4][3][LANES_PER_DIRECTION];
+
+// Time-slotted reservation table: for every tick in the horizon, one bit per
+// intersection cell that some admitted vehicle will occupy. Admitting a
+// vehicle ANDs its path's cells against the slots it will be in them, so
+// the check costs O(path length) no matter how many vehicles are around.
+typedef struct {
+    uint64_t slots[RESERVATION_HORIZON];
+    unsigned int now; // tick that slots[RESERVATION_SLOT(now)] stands for
+} ReservationTable;
+
+void initializeCrossingPaths(void); // after initializeTurnPaths
+void initReservationTable(ReservationTable* table);
+// Move on to the next tick, freeing the slot of the one that is over
+void advanceReservationTable(ReservationTable* table);
+
+// Reserve the cells a vehicle at laneAdvance (along its lane) needs to cross,
+// moving by speed on this tick and then accelerating with params as on a free
+// road, which is how admitted vehicles drive through the box (idm.h,
+// car_following.h). Commits and returns true only if none of them is taken.
+bool reserveCrossing(ReservationTable* table, const CrossingPath* path, float laneAdvance, float speed,
+                     const IdmParameters* params);
+
+// Before the vehicle update: every vehicle whose move on this tick would take
+// it into the box asks for its crossing, lane by lane in laneQueueIndex
+// order, so the outcome does not depend on the store's dense order. Those
+// refused only move up to the edge of the box and stop there, and ask again
+// once they pull away. Returns how many were held.
+int admitVehicles(ReservationTable* table, VehicleStore* store);
+
+#endif
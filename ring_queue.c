@@ -0,0 +1,148 @@
+#include <stdlib.h>
+#include <string.h>
+#include "traffic_simulation.h"
+
+// Round up to the next power of two so indices can be masked instead of divided
+static unsigned int roundUpPowerOfTwo(unsigned int value)
+{
+    unsigned int result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+// Move the queued handles into a buffer twice the size. head and tail keep
+// their free-running values so tickets handed out by enqueue stay valid.
+static bool growRingQueue(RingQueue *q)
+{
+    unsigned int newCapacity = q->capacity > 0 ? q->capacity * 2 : 1;
+    VehicleHandle *items = (VehicleHandle *)malloc(newCapacity * sizeof(VehicleHandle));
+    if (items == NULL)
+    {
+        return false;
+    }
+
+    for (unsigned int i = q->head; i != q->tail; i++)
+    {
+        items[i & (newCapacity - 1)] = q->items[i & (q->capacity - 1)];
+    }
+
+    free(q->items);
+    q->items = items;
+    q->capacity = newCapacity;
+    return true;
+}
+
+bool initRingQueue(RingQueue *q, unsigned int capacity, bool growable)
+{
+    q->capacity = roundUpPowerOfTwo(capacity > 0 ? capacity : 1);
+    q->items = (VehicleHandle *)malloc(q->capacity * sizeof(VehicleHandle));
+    q->head = q->tail = 0;
+    q->size = 0;
+    q->growable = growable;
+    if (q->items == NULL)
+    {
+        // Leave an empty queue with no storage; a growable one allocates on
+        // its first enqueue, a fixed one rejects every enqueue
+        q->capacity = 0;
+        return false;
+    }
+    return true;
+}
+
+bool ringEnqueue(RingQueue *q, VehicleHandle handle)
+{
+    if ((unsigned int)q->size == q->capacity)
+    {
+        if (!q->growable || !growRingQueue(q))
+        {
+            return false;
+        }
+    }
+    q->items[q->tail & (q->capacity - 1)] = handle;
+    q->tail++;
+    q->size++;
+    return true;
+}
+
+VehicleHandle ringDequeue(RingQueue *q)
+{
+    if (q->size == 0)
+    {
+        return INVALID_VEHICLE_HANDLE;
+    }
+    VehicleHandle handle = q->items[q->head & (q->capacity - 1)];
+    q->head++;
+    q->size--;
+    return handle;
+}
+
+// Copy a batch in with at most two memcpys (the second only when it wraps)
+int ringEnqueueN(RingQueue *q, const VehicleHandle *handles, int count)
+{
+    if (count <= 0)
+    {
+        return 0;
+    }
+    while (q->capacity - (unsigned int)q->size < (unsigned int)count)
+    {
+        if (!q->growable || !growRingQueue(q))
+        {
+            count = q->capacity - q->size;
+            break;
+        }
+    }
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    unsigned int start = q->tail & (q->capacity - 1);
+    unsigned int firstPart = q->capacity - start;
+    if (firstPart > (unsigned int)count)
+    {
+        firstPart = count;
+    }
+    memcpy(q->items + start, handles, firstPart * sizeof(VehicleHandle));
+    memcpy(q->items, handles + firstPart, (count - firstPart) * sizeof(VehicleHandle));
+    q->tail += count;
+    q->size += count;
+    return count;
+}
+
+int ringDequeueN(RingQueue *q, VehicleHandle *out, int maxCount)
+{
+    int count = q->size < maxCount ? q->size : maxCount;
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    unsigned int start = q->head & (q->capacity - 1);
+    unsigned int firstPart = q->capacity - start;
+    if (firstPart > (unsigned int)count)
+    {
+        firstPart = count;
+    }
+    memcpy(out, q->items + start, firstPart * sizeof(VehicleHandle));
+    memcpy(out + firstPart, q->items, (count - firstPart) * sizeof(VehicleHandle));
+    q->head += count;
+    q->size -= count;
+    return count;
+}
+
+int isRingQueueEmpty(RingQueue *q)
+{
+    return q->size == 0;
+}
+
+void freeRingQueue(RingQueue *q)
+{
+    free(q->items);
+    q->items = NULL;
+    q->head = q->tail = 0;
+    q->capacity = 0;
+    q->size = 0;
+}
@@ -0,0 +1,279 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "traffic_simulation.h"
+#include "vehicle_store.h"
+#include "vehicle_kernels.h"
+#include "parallel_update.h"
+
+// Consistency checks for the simulation core (the SimCheck target, run by
+// ctest). Each check drives the same seeded scenario through two paths that
+// must agree bit for bit, and prints one line per comparison. The exit code
+// is the number of comparisons that failed.
+#define CHECK_SEED 5
+#define CHECK_TICKS 400
+// Not a multiple of any SIMD width, so the scalar tails of the kernels run too
+#define KERNEL_CHECK_VEHICLES 1021
+// Enough for the pool to split the update (PARALLEL_UPDATE_MIN_VEHICLES), with
+// a last chunk that is not a whole PARALLEL_UPDATE_CHUNK_ALIGN
+#define POOL_CHECK_VEHICLES (3 * PARALLEL_UPDATE_MIN_VEHICLES + 37)
+#define POOL_CHECK_MAX_THREADS 4
+
+// Linear congruential generator, so the scenario does not depend on the C
+// library's rand
+static unsigned int nextRandom(unsigned int *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+static float randomFloat(unsigned int *state, float low, float high)
+{
+    return low + (high - low) * (float)(nextRandom(state) & 0xFFFF) / 65535.0f;
+}
+
+// Vehicles of every type, direction and state, spread over the whole screen
+// and its cull margin. Straight vehicles never carry STATE_TURNING, which
+// only turning vehicles have.
+static void buildScenario(VehicleStore *store, int count)
+{
+    unsigned int state = CHECK_SEED;
+    for (int i = 0; i < count; i++)
+    {
+        Vehicle vehicle = {0};
+        vehicle.direction = (uint8_t)(nextRandom(&state) % 4);
+        vehicle.type = (uint8_t)(nextRandom(&state) % 4);
+        vehicle.turnDirection = (uint8_t)(nextRandom(&state) % 4 == 0 ? 1 + nextRandom(&state) % 2 : TURN_NONE);
+        vehicle.state = (uint8_t)(vehicle.turnDirection != TURN_NONE && nextRandom(&state) % 2 == 0
+                                      ? STATE_TURNING
+                                      : nextRandom(&state) % 3);
+        vehicle.isInRightLane = nextRandom(&state) % 2 == 0;
+        vehicle.x = randomFloat(&state, -150.0f, WINDOW_WIDTH + 150.0f);
+        vehicle.y = randomFloat(&state, -150.0f, WINDOW_HEIGHT + 150.0f);
+        vehicle.speed = randomFloat(&state, 0.0f, 4.0f);
+        vehicle.active = true;
+        vehicleStoreSpawn(store, &vehicle);
+        // Some vehicles have left but were not swap-removed yet
+        if (nextRandom(&state) % 8 == 0)
+        {
+            store->active[store->awakeCount - 1] = false;
+        }
+    }
+}
+
+// Gaps and leader speeds for one tick, the same for every path; some gaps
+// fall below IDM_MIN_GAP and some vehicles see a free road
+static void tickInputs(int tick, float *gap, float *leaderSpeed, int count)
+{
+    unsigned int state = CHECK_SEED + (unsigned int)tick * 7919u;
+    for (int i = 0; i < count; i++)
+    {
+        unsigned int roll = nextRandom(&state) % 16;
+        gap[i] = roll == 0 ? IDM_FREE_GAP : roll == 1 ? randomFloat(&state, 0.0f, IDM_MIN_GAP)
+                                                      : randomFloat(&state, 0.0f, 120.0f);
+        leaderSpeed[i] = randomFloat(&state, 0.0f, 4.0f);
+    }
+}
+
+// The scalar reference: idmAcceleration with the state rule documented in
+// vehicle_kernels.h, then updateVehicleRef for the straight vehicles
+static void referenceTick(VehicleStore *store, const float *gap, const float *leaderSpeed)
+{
+    for (int i = 0; i < store->awakeCount; i++)
+    {
+        if (!store->active[i])
+        {
+            continue;
+        }
+        float speed = store->speed[i];
+        float acceleration = idmAcceleration(&IDM_PARAMETERS[store->type[i]], speed, gap[i], leaderSpeed[i]);
+        float next = speed + acceleration;
+        bool braking = acceleration < -IDM_BRAKING_THRESHOLD;
+        bool stalled = acceleration <= 0.0f && next < IDM_STOPPED_SPEED;
+        store->speed[i] = stalled ? 0.0f : next;
+        if (store->state[i] != STATE_TURNING)
+        {
+            store->state[i] = stalled ? STATE_STOPPED : braking ? STATE_STOPPING : STATE_MOVING;
+        }
+    }
+    for (int i = 0; i < store->awakeCount; i++)
+    {
+        if (store->turnDirection[i] == TURN_NONE)
+        {
+            updateVehicleRef(vehicleStoreRef(store, i));
+        }
+    }
+}
+
+// Dense entries whose simulated fields differ in any bit
+static int countDifferences(const VehicleStore *a, const VehicleStore *b)
+{
+    if (a->awakeCount != b->awakeCount)
+    {
+        return a->awakeCount > b->awakeCount ? a->awakeCount : b->awakeCount;
+    }
+    int differences = 0;
+    for (int i = 0; i < a->awakeCount; i++)
+    {
+        if (memcmp(&a->x[i], &b->x[i], sizeof(float)) != 0 || memcmp(&a->y[i], &b->y[i], sizeof(float)) != 0 ||
+            memcmp(&a->speed[i], &b->speed[i], sizeof(float)) != 0 || a->state[i] != b->state[i] ||
+            a->active[i] != b->active[i])
+        {
+            differences++;
+        }
+    }
+    return differences;
+}
+
+static void report(const char *check, int differences, int vehicles, int *failures)
+{
+    printf("%-32s %s (%d of %d vehicles differ)\n", check, differences == 0 ? "ok" : "FAILED", differences, vehicles);
+    if (differences != 0)
+    {
+        (*failures)++;
+    }
+}
+
+// Every batch kernel the CPU supports against the scalar reference
+static void checkKernels(int *failures)
+{
+    float *gap = (float *)malloc(KERNEL_CHECK_VEHICLES * sizeof(float));
+    float *leaderSpeed = (float *)malloc(KERNEL_CHECK_VEHICLES * sizeof(float));
+    VehicleStore reference;
+    if (gap == NULL || leaderSpeed == NULL || !initVehicleStore(&reference, KERNEL_CHECK_VEHICLES))
+    {
+        fprintf(stderr, "Out of memory setting up the kernel check\n");
+        free(gap);
+        free(leaderSpeed);
+        (*failures)++;
+        return;
+    }
+    buildScenario(&reference, KERNEL_CHECK_VEHICLES);
+    for (int tick = 0; tick < CHECK_TICKS; tick++)
+    {
+        tickInputs(tick, gap, leaderSpeed, KERNEL_CHECK_VEHICLES);
+        referenceTick(&reference, gap, leaderSpeed);
+    }
+
+    const VehicleKernel kernels[] = {VEHICLE_KERNEL_SCALAR, VEHICLE_KERNEL_SSE2, VEHICLE_KERNEL_AVX2};
+    for (int k = 0; k < (int)(sizeof(kernels) / sizeof(kernels[0])); k++)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "kernel %s", vehicleKernelName(kernels[k]));
+        if (!selectVehicleKernel(kernels[k]))
+        {
+            printf("%-32s skipped (not supported here)\n", name);
+            continue;
+        }
+
+        VehicleStore store;
+        if (!initVehicleStore(&store, KERNEL_CHECK_VEHICLES))
+        {
+            fprintf(stderr, "Out of memory setting up the kernel check\n");
+            (*failures)++;
+            continue;
+        }
+        buildScenario(&store, KERNEL_CHECK_VEHICLES);
+        for (int tick = 0; tick < CHECK_TICKS; tick++)
+        {
+            tickInputs(tick, gap, leaderSpeed, KERNEL_CHECK_VEHICLES);
+            updateIdmSpeeds(&store, gap, leaderSpeed, 0, store.awakeCount);
+            updateStraightVehicles(&store, 0, store.awakeCount);
+        }
+        report(name, countDifferences(&reference, &store), KERNEL_CHECK_VEHICLES, failures);
+        freeVehicleStore(&store);
+    }
+
+    freeVehicleStore(&reference);
+    free(gap);
+    free(leaderSpeed);
+}
+
+// One tick as stepSimulation runs it: speeds from the active kernel, the move
+// (split across the pool unless it is NULL), then the vehicles that left are
+// swap-removed on this thread
+static void poolTick(UpdatePool *pool, VehicleStore *store, const float *gap, const float *leaderSpeed)
+{
+    updateIdmSpeeds(store, gap, leaderSpeed, 0, store->awakeCount);
+    updateActiveVehicles(pool, store);
+    for (int i = 0; i < store->awakeCount;)
+    {
+        if (store->active[i])
+        {
+            i++;
+            continue;
+        }
+        vehicleStoreDeactivate(store, i);
+    }
+}
+
+// The update pool with 2 to POOL_CHECK_MAX_THREADS threads against the serial update
+static void checkUpdatePool(int *failures)
+{
+    activeVehicleKernel(); // the widest kernel, as the simulation uses
+    float *gap = (float *)malloc(POOL_CHECK_VEHICLES * sizeof(float));
+    float *leaderSpeed = (float *)malloc(POOL_CHECK_VEHICLES * sizeof(float));
+    VehicleStore serial;
+    if (gap == NULL || leaderSpeed == NULL || !initVehicleStore(&serial, POOL_CHECK_VEHICLES))
+    {
+        fprintf(stderr, "Out of memory setting up the update pool check\n");
+        free(gap);
+        free(leaderSpeed);
+        (*failures)++;
+        return;
+    }
+    buildScenario(&serial, POOL_CHECK_VEHICLES);
+    for (int tick = 0; tick < CHECK_TICKS; tick++)
+    {
+        tickInputs(tick, gap, leaderSpeed, POOL_CHECK_VEHICLES);
+        poolTick(NULL, &serial, gap, leaderSpeed);
+    }
+
+    for (int threads = 2; threads <= POOL_CHECK_MAX_THREADS; threads++)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "update pool, %d threads", threads);
+        UpdatePool *pool = createUpdatePool(threads);
+        if (pool == NULL)
+        {
+#ifdef SIM_HAVE_THREADS
+            printf("%-32s FAILED (could not start the threads)\n", name);
+            (*failures)++;
+#else
+            printf("%-32s skipped (no threads in this build)\n", name);
+#endif
+            continue;
+        }
+
+        VehicleStore pooled;
+        if (!initVehicleStore(&pooled, POOL_CHECK_VEHICLES))
+        {
+            fprintf(stderr, "Out of memory setting up the update pool check\n");
+            destroyUpdatePool(pool);
+            (*failures)++;
+            continue;
+        }
+        buildScenario(&pooled, POOL_CHECK_VEHICLES);
+        for (int tick = 0; tick < CHECK_TICKS; tick++)
+        {
+            tickInputs(tick, gap, leaderSpeed, POOL_CHECK_VEHICLES);
+            poolTick(pool, &pooled, gap, leaderSpeed);
+        }
+        report(name, countDifferences(&serial, &pooled), POOL_CHECK_VEHICLES, failures);
+        freeVehicleStore(&pooled);
+        destroyUpdatePool(pool);
+    }
+
+    freeVehicleStore(&serial);
+    free(gap);
+    free(leaderSpeed);
+}
+
+int main(void)
+{
+    int failures = 0;
+    initializeTurnPaths();
+    checkKernels(&failures);
+    checkUpdatePool(&failures);
+    return failures;
+}
@@ -0,0 +1,40 @@
+#include "sim_clock.h"
+
+void initSimClock(SimClock *clock, float speed, Uint32 realTicks)
+{
+    clock->now = 0;
+    clock->lastRealTicks = realTicks;
+    clock->accumulator = 0.0;
+    clock->speed = speed > 0.0f ? speed : 0.0f;
+}
+
+bool simClockUnthrottled(const SimClock *clock)
+{
+    return clock->speed == 0.0f;
+}
+
+int simClockStepsDue(SimClock *clock, Uint32 realTicks)
+{
+    Uint32 elapsed = realTicks - clock->lastRealTicks;
+    clock->lastRealTicks = realTicks;
+    if (simClockUnthrottled(clock))
+    {
+        return SIM_MAX_STEPS_PER_FRAME;
+    }
+
+    clock->accumulator += elapsed * (double)clock->speed;
+    int steps = (int)(clock->accumulator / SIM_TICK_MS);
+    if (steps > SIM_MAX_STEPS_PER_FRAME)
+    {
+        // Too far behind: drop the backlog rather than stall on it
+        clock->accumulator = 0.0;
+        return SIM_MAX_STEPS_PER_FRAME;
+    }
+    clock->accumulator -= steps * (double)SIM_TICK_MS;
+    return steps;
+}
+
+void simClockTick(SimClock *clock)
+{
+    clock->now += SIM_TICK_MS;
+}
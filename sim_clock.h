@@ -0,0 +1,32 @@
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <stdbool.h>
+#include "sim_platform.h"
+
+// Simulated milliseconds per step; every step moves vehicles by one update
+#define SIM_TICK_MS 16
+// Most steps one frame may run to catch up. Real time beyond that is dropped
+// instead of snowballing when the machine cannot keep up with the speed.
+#define SIM_MAX_STEPS_PER_FRAME 1000
+
+// Fixed-timestep simulation clock. Real time scaled by speed accumulates, and
+// the simulation takes as many whole SIM_TICK_MS steps as have built up, so
+// the outcome depends only on the step count, never on the frame rate.
+// Spawning, light cycles and statistics all read now instead of SDL_GetTicks.
+typedef struct {
+    Uint32 now;           // simulated milliseconds since start
+    Uint32 lastRealTicks;
+    double accumulator;   // scaled real milliseconds not yet simulated
+    float speed;          // simulated ms per real ms; 0 runs as fast as possible
+} SimClock;
+
+void initSimClock(SimClock* clock, float speed, Uint32 realTicks);
+// Steps the simulation owes for the real time since the last call. Unthrottled
+// clocks always report SIM_MAX_STEPS_PER_FRAME; the caller decides when to stop.
+int simClockStepsDue(SimClock* clock, Uint32 realTicks);
+bool simClockUnthrottled(const SimClock* clock);
+// Advance simulated time by one step
+void simClockTick(SimClock* clock);
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef SIM_PLATFORM_H
+#define SIM_PLATFORM_H
+
+// The simulation core only uses a few plain SDL types, atomics and thread
+// calls. Headless builds (SIM_HEADLESS, the SimHeadless target) declare them
+// here instead of including SDL.h, so the core compiles and links without
+// SDL; rendering and CPU detection through SDL are left out of those builds.
+// SIM_HAVE_THREADS is defined where SDL_Thread and SDL_sem can be used: with
+// SDL, and in headless builds on POSIX threads. Headless Windows builds have
+// no threads and update serially.
+#ifdef SIM_HEADLESS
+#include <stdint.h>
+
+typedef uint8_t Uint8;
+typedef uint32_t Uint32;
+
+typedef struct SDL_Rect {
+    int x, y;
+    int w, h;
+} SDL_Rect;
+
+// SDL's atomics, for the lock-free MpscQueue (QUEUE_MPSC); every operation
+// is sequentially consistent like SDL's own
+typedef struct {
+    int value;
+} SDL_atomic_t;
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+
+static inline int SDL_AtomicGet(SDL_atomic_t* a) { return (int)_InterlockedOr((volatile long*)&a->value, 0); }
+static inline int SDL_AtomicSet(SDL_atomic_t* a, int v) { return (int)_InterlockedExchange((volatile long*)&a->value, v); }
+static inline int SDL_AtomicCAS(SDL_atomic_t* a, int oldValue, int newValue)
+{
+    return _InterlockedCompareExchange((volatile long*)&a->value, newValue, oldValue) == oldValue;
+}
+#define SDL_MemoryBarrierRelease() _ReadWriteBarrier()
+#define SDL_MemoryBarrierAcquire() _ReadWriteBarrier()
+#else
+static inline int SDL_AtomicGet(SDL_atomic_t* a) { return __atomic_load_n(&a->value, __ATOMIC_SEQ_CST); }
+static inline int SDL_AtomicSet(SDL_atomic_t* a, int v) { return __atomic_exchange_n(&a->value, v, __ATOMIC_SEQ_CST); }
+static inline int SDL_AtomicCAS(SDL_atomic_t* a, int oldValue, int newValue)
+{
+    return __atomic_compare_exchange_n(&a->value, &oldValue, newValue, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+#define SDL_MemoryBarrierRelease() __atomic_thread_fence(__ATOMIC_RELEASE)
+#define SDL_MemoryBarrierAcquire() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#endif
+
+// SDL's threads and semaphores on POSIX threads, for the update pool
+// (parallel_update.h). The semaphore is a mutex and condition variable
+// because unnamed POSIX semaphores are missing on macOS.
+#ifndef _WIN32
+#include <pthread.h>
+#include <stdlib.h>
+
+#define SIM_HAVE_THREADS 1
+
+typedef int (*SDL_ThreadFunction)(void* data);
+
+typedef struct SDL_Thread {
+    pthread_t thread;
+    SDL_ThreadFunction function;
+    void* data;
+    int status;
+} SDL_Thread;
+
+typedef struct SDL_sem {
+    pthread_mutex_t lock;
+    pthread_cond_t posted;
+    Uint32 count;
+} SDL_sem;
+
+static inline void* simThreadStart(void* data)
+{
+    SDL_Thread* thread = (SDL_Thread*)data;
+    thread->status = thread->function(thread->data);
+    return NULL;
+}
+
+static inline SDL_Thread* SDL_CreateThread(SDL_ThreadFunction function, const char* name, void* data)
+{
+    (void)name;
+    SDL_Thread* thread = (SDL_Thread*)malloc(sizeof(SDL_Thread));
+    if (thread == NULL)
+    {
+        return NULL;
+    }
+    thread->function = function;
+    thread->data = data;
+    thread->status = 0;
+    if (pthread_create(&thread->thread, NULL, simThreadStart, thread) != 0)
+    {
+        free(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+static inline void SDL_WaitThread(SDL_Thread* thread, int* status)
+{
+    if (thread == NULL)
+    {
+        return;
+    }
+    pthread_join(thread->thread, NULL);
+    if (status != NULL)
+    {
+        *status = thread->status;
+    }
+    free(thread);
+}
+
+static inline SDL_sem* SDL_CreateSemaphore(Uint32 initialValue)
+{
+    SDL_sem* sem = (SDL_sem*)malloc(sizeof(SDL_sem));
+    if (sem == NULL)
+    {
+        return NULL;
+    }
+    if (pthread_mutex_init(&sem->lock, NULL) != 0)
+    {
+        free(sem);
+        return NULL;
+    }
+    if (pthread_cond_init(&sem->posted, NULL) != 0)
+    {
+        pthread_mutex_destroy(&sem->lock);
+        free(sem);
+        return NULL;
+    }
+    sem->count = initialValue;
+    return sem;
+}
+
+static inline void SDL_DestroySemaphore(SDL_sem* sem)
+{
+    if (sem == NULL)
+    {
+        return;
+    }
+    pthread_cond_destroy(&sem->posted);
+    pthread_mutex_destroy(&sem->lock);
+    free(sem);
+}
+
+static inline int SDL_SemWait(SDL_sem* sem)
+{
+    pthread_mutex_lock(&sem->lock);
+    while (sem->count == 0)
+    {
+        pthread_cond_wait(&sem->posted, &sem->lock);
+    }
+    sem->count--;
+    pthread_mutex_unlock(&sem->lock);
+    return 0;
+}
+
+static inline int SDL_SemPost(SDL_sem* sem)
+{
+    pthread_mutex_lock(&sem->lock);
+    sem->count++;
+    pthread_cond_signal(&sem->posted);
+    pthread_mutex_unlock(&sem->lock);
+    return 0;
+}
+#endif
+#else
+#include <SDL.h>
+
+#define SIM_HAVE_THREADS 1
+#endif
+
+#endif
@@ -2,11 +2,66 @@
 #include <stdlib.h>
 #include <math.h>
 #include "traffic_simulation.h"
+#include "priority_queue.h"
+#include "vehicle_store.h"
+
+// SDL.h used to supply this; headless builds go without it
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
 
 // Global queues for lanes
-Queue laneQueues[4];         // Queues for lanes A, B, C, D
+Queue laneQueues[LANE_QUEUE_COUNT]; // Two lanes for each of approaches A, B, C, D
 int lanePriorities[4] = {0}; // Priority levels for lanes (0 = normal, 1 = high)
 
+// Per-approach geometry, so updateVehicleRef indexes tables instead of
+// switching on direction. Northbound traffic drives up the screen (y falls),
+// eastbound traffic to the right (x grows).
+const DirectionGeometry DIRECTION_GEOMETRY[4] = {
+    [DIRECTION_NORTH] = {.axis = AXIS_Y, .sign = -1.0f, .intersectionEdge = INTERSECTION_Y + LANE_WIDTH},
+    [DIRECTION_SOUTH] = {.axis = AXIS_Y, .sign = 1.0f, .intersectionEdge = INTERSECTION_Y - LANE_WIDTH},
+    [DIRECTION_EAST] = {.axis = AXIS_X, .sign = 1.0f, .intersectionEdge = INTERSECTION_X - LANE_WIDTH},
+    [DIRECTION_WEST] = {.axis = AXIS_X, .sign = -1.0f, .intersectionEdge = INTERSECTION_X + LANE_WIDTH},
+};
+
+// Direction a vehicle leaves in, by direction and TurnDirection
+const Direction TURN_EXIT_DIRECTION[4][3] = {
+    [DIRECTION_NORTH] = {DIRECTION_NORTH, DIRECTION_WEST, DIRECTION_EAST},
+    [DIRECTION_SOUTH] = {DIRECTION_SOUTH, DIRECTION_EAST, DIRECTION_WEST},
+    [DIRECTION_EAST] = {DIRECTION_EAST, DIRECTION_NORTH, DIRECTION_SOUTH},
+    [DIRECTION_WEST] = {DIRECTION_WEST, DIRECTION_SOUTH, DIRECTION_NORTH},
+};
+
+// Cruising speeds are the fixed speeds each type used to drive at. The
+// minimum gap matches FOLLOW_GAP, and headways are short because the
+// approaches are only a few car lengths long.
+const IdmParameters IDM_PARAMETERS[4] = {
+    [REGULAR_CAR] = {.desiredSpeed = 2.0f, .maxAcceleration = 0.10f, .comfortDeceleration = 0.20f,
+                     .minimumGap = 8.0f, .timeHeadway = 8.0f},
+    [AMBULANCE] = {.desiredSpeed = 4.0f, .maxAcceleration = 0.20f, .comfortDeceleration = 0.30f,
+                   .minimumGap = 8.0f, .timeHeadway = 6.0f},
+    [POLICE_CAR] = {.desiredSpeed = 4.0f, .maxAcceleration = 0.20f, .comfortDeceleration = 0.30f,
+                    .minimumGap = 8.0f, .timeHeadway = 6.0f},
+    [FIRE_TRUCK] = {.desiredSpeed = 3.5f, .maxAcceleration = 0.12f, .comfortDeceleration = 0.25f,
+                    .minimumGap = 10.0f, .timeHeadway = 8.0f},
+};
+
+// The batch kernels in vehicle_kernels.c repeat these operations in this
+// order, so both give bit-identical speeds
+float idmAcceleration(const IdmParameters *params, float speed, float gap, float leaderSpeed)
+{
+    float ratio = speed / params->desiredSpeed;
+    float ratio2 = ratio * ratio;
+    float dynamic = speed * params->timeHeadway +
+                    speed * (speed - leaderSpeed) / (2.0f * sqrtf(params->maxAcceleration * params->comfortDeceleration));
+    float desiredGap = params->minimumGap + (dynamic > 0.0f ? dynamic : 0.0f);
+    float interaction = desiredGap / (gap > IDM_MIN_GAP ? gap : IDM_MIN_GAP);
+    return params->maxAcceleration * (1.0f - ratio2 * ratio2 - interaction * interaction);
+}
+
+TurnPath turnPaths[4][3][LANES_PER_DIRECTION];
+
+#ifndef SIM_HEADLESS
 // Updated modern color scheme for vehicles
 const SDL_Color VEHICLE_COLORS[] = {
     {60, 60, 70, 255},       // REGULAR_CAR: Dark slate gray
@@ -23,6 +78,7 @@ const SDL_Color STOP_LINE_COLOR = {255, 255, 255, 255};    // White stop lines
 const SDL_Color BACKGROUND_COLOR = {100, 180, 130, 255};   // Light green background (grass/terrain)
 const SDL_Color QUEUE_FRAME_COLOR = {50, 50, 60, 200};     // Dark frame for queue display
 const SDL_Color QUEUE_BG_COLOR = {220, 220, 220, 180};     // Light gray semi-transparent background
+#endif
 
 void initializeTrafficLights(TrafficLight *lights)
 {
@@ -48,43 +104,158 @@ void initializeTrafficLights(TrafficLight *lights)
         .direction = DIRECTION_WEST};
 }
 
-void updateTrafficLights(TrafficLight *lights)
+// North/south and east/west traffic cross each other, so the lights run as
+// two phases: both lights of one axis are green while the other two are red
+static void setTrafficPhase(TrafficLight *lights, bool northSouthGreen)
+{
+    lights[DIRECTION_NORTH].state = lights[DIRECTION_SOUTH].state = northSouthGreen ? GREEN : RED;
+    lights[DIRECTION_EAST].state = lights[DIRECTION_WEST].state = northSouthGreen ? RED : GREEN;
+}
+
+// Priority of the most urgent emergency vehicle waiting on either approach of
+// an axis, -1 if there is none
+static int waitingEmergencyPriority(Direction first, Direction second)
+{
+    int priority = -1;
+    Direction approaches[2] = {first, second};
+    for (int a = 0; a < 2; a++)
+    {
+        VehicleType waitingType;
+        if (highestWaitingType(&priorityLaneQueues[approaches[a]], &waitingType) && waitingType != REGULAR_CAR &&
+            vehiclePriority(waitingType) > priority)
+        {
+            priority = vehiclePriority(waitingType);
+        }
+    }
+    return priority;
+}
+
+unsigned int updateTrafficLights(TrafficLight *lights, Uint32 now)
 {
-    Uint32 currentTicks = SDL_GetTicks();
     static Uint32 lastUpdateTicks = 0;
+    TrafficLightState before[4];
+    for (int i = 0; i < 4; i++)
+    {
+        before[i] = lights[i].state;
+    }
+    bool northSouthGreen = lights[DIRECTION_NORTH].state == GREEN;
+
+    if (now - lastUpdateTicks >= 5000)
+    { // Change phase every 5 simulated seconds
+        lastUpdateTicks = now;
 
-    if (currentTicks - lastUpdateTicks >= 5000)
-    { // Change lights every 5 seconds
-        lastUpdateTicks = currentTicks;
+        // Total waiting vehicles per approach in one pass over the lane queues
+        int approachSizes[4] = {0};
+        for (int lane = 0; lane < LANE_QUEUE_COUNT; lane++)
+        {
+            approachSizes[LANE_QUEUE_DIRECTION(lane)] += queueSize(&laneQueues[lane]);
+        }
 
         // Check for high-priority lanes
         for (int i = 0; i < 4; i++)
         {
-            if (laneQueues[i].size > 10)
+            if (approachSizes[i] > 10)
             {
                 lanePriorities[i] = 1; // Set high priority
             }
-            else if (laneQueues[i].size < 5)
+            else if (approachSizes[i] < 5)
             {
                 lanePriorities[i] = 0; // Reset to normal priority
             }
         }
 
-        // Toggle lights based on priority
-        for (int i = 0; i < 4; i++)
+        // A congested axis keeps (or gets) the green; otherwise the phases alternate
+        bool northSouthBusy = lanePriorities[DIRECTION_NORTH] || lanePriorities[DIRECTION_SOUTH];
+        bool eastWestBusy = lanePriorities[DIRECTION_EAST] || lanePriorities[DIRECTION_WEST];
+        northSouthGreen = northSouthBusy != eastWestBusy ? northSouthBusy : !northSouthGreen;
+    }
+
+    // Emergency vehicles waiting on an approach get its phase right away; if
+    // both axes have one, the more urgent wins and a tie keeps the phase
+    int northSouthEmergency = waitingEmergencyPriority(DIRECTION_NORTH, DIRECTION_SOUTH);
+    int eastWestEmergency = waitingEmergencyPriority(DIRECTION_EAST, DIRECTION_WEST);
+    if (northSouthEmergency != eastWestEmergency)
+    {
+        bool wanted = northSouthEmergency > eastWestEmergency;
+        if (wanted != northSouthGreen)
         {
-            if (lanePriorities[i] == 1)
-            {
-                lights[i].state = GREEN; // Give green light to high-priority lane
-            }
-            else
+            northSouthGreen = wanted;
+            lastUpdateTicks = now; // the new phase runs a full interval
+        }
+    }
+    setTrafficPhase(lights, northSouthGreen);
+
+    unsigned int turnedGreen = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        if (before[i] == RED && lights[i].state == GREEN)
+        {
+            turnedGreen |= 1u << i;
+        }
+    }
+    return turnedGreen;
+}
+
+// Offset of a lane's vehicles from the road center line, matching the spawn
+// positions in createVehicle (vehicles are 20 px across their lane)
+static float laneOffset(int lane)
+{
+    return -LANE_WIDTH / 2 + lane * LANE_WIDTH + (LANE_WIDTH / 4 - 10);
+}
+
+// Build every turning path once. Entering along heading h0 and leaving along
+// h1, the quarter circle of radius R is R*sin(t)*h0 + R*(1 - cos(t))*h1 for t
+// in [0, 90 deg]; it starts R before the exit lane so it ends exactly on it.
+void initializeTurnPaths(void)
+{
+    for (int direction = 0; direction < 4; direction++)
+    {
+        const DirectionGeometry *entry = &DIRECTION_GEOMETRY[direction];
+        float h0x = entry->axis == AXIS_X ? entry->sign : 0.0f;
+        float h0y = entry->axis == AXIS_Y ? entry->sign : 0.0f;
+        float center = entry->axis == AXIS_X ? INTERSECTION_X : INTERSECTION_Y;
+
+        for (int turn = TURN_LEFT; turn <= TURN_RIGHT; turn++)
+        {
+            const DirectionGeometry *exit = &DIRECTION_GEOMETRY[TURN_EXIT_DIRECTION[direction][turn]];
+            float h1x = exit->axis == AXIS_X ? exit->sign : 0.0f;
+            float h1y = exit->axis == AXIS_Y ? exit->sign : 0.0f;
+
+            for (int lane = 0; lane < LANES_PER_DIRECTION; lane++)
             {
-                lights[i].state = (lights[i].state == RED) ? GREEN : RED; // Toggle lights
+                TurnPath *path = &turnPaths[direction][turn][lane];
+                path->start = center + laneOffset(lane) - entry->sign * TURN_RADIUS;
+                for (int k = 0; k <= TURN_PATH_SEGMENTS; k++)
+                {
+                    double angle = (M_PI / 2) * k / TURN_PATH_SEGMENTS;
+                    float forward = (float)(TURN_RADIUS * sin(angle));
+                    float sideways = (float)(TURN_RADIUS * (1.0 - cos(angle)));
+                    path->dx[k] = forward * h0x + sideways * h1x;
+                    path->dy[k] = forward * h0y + sideways * h1y;
+                }
+                path->segmentLength = (float)(2.0 * TURN_RADIUS * sin(M_PI / (4.0 * TURN_PATH_SEGMENTS)));
+                path->length = path->segmentLength * TURN_PATH_SEGMENTS;
             }
         }
     }
 }
 
+// Point on a turning path at the given distance from its start
+static void turnPathOffset(const TurnPath *path, float distance, float *dx, float *dy)
+{
+    float position = distance / path->segmentLength;
+    int segment = (int)position;
+    if (segment >= TURN_PATH_SEGMENTS)
+    {
+        *dx = path->dx[TURN_PATH_SEGMENTS];
+        *dy = path->dy[TURN_PATH_SEGMENTS];
+        return;
+    }
+    float t = position - segment;
+    *dx = path->dx[segment] + (path->dx[segment + 1] - path->dx[segment]) * t;
+    *dy = path->dy[segment] + (path->dy[segment + 1] - path->dy[segment]) * t;
+}
+
 Vehicle *createVehicle(Direction direction)
 {
     Vehicle *vehicle = (Vehicle *)malloc(sizeof(Vehicle));
@@ -110,23 +281,12 @@ Vehicle *createVehicle(Direction direction)
     }
 
     vehicle->active = true;
-    // Set speed based on vehicle type
-    switch (vehicle->type)
-    {
-    case AMBULANCE:
-    case POLICE_CAR:
-        vehicle->speed = 4.0f;
-        break;
-    case FIRE_TRUCK:
-        vehicle->speed = 3.5f;
-        break;
-    default:
-        vehicle->speed = 2.0f;
-    }
+    vehicle->speed = IDM_PARAMETERS[vehicle->type].desiredSpeed;
 
     vehicle->state = STATE_MOVING;
     vehicle->turnAngle = 0.0f;
     vehicle->turnProgress = 0.0f;
+    vehicle->inLaneQueue = false;
 
     // 30% chance to turn
     int turnChance = rand() % 100;
@@ -139,18 +299,6 @@ Vehicle *createVehicle(Direction direction)
         vehicle->turnDirection = TURN_NONE;
     }
 
-    // Set dimensions based on direction
-    if (direction == DIRECTION_NORTH || direction == DIRECTION_SOUTH)
-    {
-        vehicle->rect.w = 20; // width
-        vehicle->rect.h = 30; // height
-    }
-    else
-    {
-        vehicle->rect.w = 30; // width
-        vehicle->rect.h = 20; // height
-    }
-
     // Fixed spawn positions for each direction
     switch (direction)
     {
@@ -160,7 +308,7 @@ Vehicle *createVehicle(Direction direction)
         { // Randomly choose right lane
             vehicle->x += LANE_WIDTH;
         }
-        vehicle->y = WINDOW_HEIGHT - vehicle->rect.h;
+        vehicle->y = WINDOW_HEIGHT - VEHICLE_LENGTH;
         vehicle->isInRightLane = (vehicle->x > INTERSECTION_X);
         break;
 
@@ -185,7 +333,7 @@ Vehicle *createVehicle(Direction direction)
         break;
 
     case DIRECTION_WEST: // Spawns at right, moves left
-        vehicle->x = WINDOW_WIDTH - vehicle->rect.w;
+        vehicle->x = WINDOW_WIDTH - VEHICLE_LENGTH;
         vehicle->y = INTERSECTION_Y - LANE_WIDTH / 2; // Top lane
         if (rand() % 2)
         { // Randomly choose bottom lane
@@ -198,312 +346,141 @@ Vehicle *createVehicle(Direction direction)
     // Center vehicle in lane
     if (direction == DIRECTION_NORTH || direction == DIRECTION_SOUTH)
     {
-        vehicle->x += (LANE_WIDTH / 4 - vehicle->rect.w / 2); // Center in lane
+        vehicle->x += (LANE_WIDTH / 4 - VEHICLE_WIDTH / 2); // Center in lane
     }
     else
     {
-        vehicle->y += (LANE_WIDTH / 4 - vehicle->rect.h / 2); // Center in lane
+        vehicle->y += (LANE_WIDTH / 4 - VEHICLE_WIDTH / 2); // Center in lane
     }
 
-    vehicle->rect.x = (int)vehicle->x;
-    vehicle->rect.y = (int)vehicle->y;
-
     return vehicle;
 }
 
-void updateVehicle(Vehicle *vehicle, TrafficLight *lights)
+// Point at the fields of a plain Vehicle so updateVehicleRef can run on it
+VehicleRef vehicleRef(Vehicle *vehicle)
 {
-    if (!vehicle->active)
-        return;
-
-    float stopLine = 0;
-    bool shouldStop = false;
-    float stopDistance = 40.0f;
-    float turnPoint = 0;
-    bool hasEmergencyPriority = (vehicle->type != REGULAR_CAR);
+    VehicleRef ref = {
+        .x = &vehicle->x,
+        .y = &vehicle->y,
+        .speed = &vehicle->speed,
+        .turnAngle = &vehicle->turnAngle,
+        .type = &vehicle->type,
+        .direction = &vehicle->direction,
+        .turnDirection = &vehicle->turnDirection,
+        .state = &vehicle->state,
+        .active = &vehicle->active,
+        .isInRightLane = &vehicle->isInRightLane,
+        .turnProgress = &vehicle->turnProgress};
+    return ref;
+}
 
-    // Calculate stop line based on direction
-    switch (vehicle->direction)
+// Screen rectangle of a vehicle at (x, y), long side along its direction
+SDL_Rect vehicleFootprint(Direction direction, float x, float y)
+{
+    SDL_Rect rect = {(int)x, (int)y, VEHICLE_LENGTH, VEHICLE_WIDTH};
+    if (direction == DIRECTION_NORTH || direction == DIRECTION_SOUTH)
     {
-    case DIRECTION_NORTH:
-        stopLine = INTERSECTION_Y + LANE_WIDTH + 40;
-        if (vehicle->turnDirection == TURN_LEFT)
-        {
-            turnPoint = INTERSECTION_Y - LANE_WIDTH / 4;
-        }
-        else if (vehicle->turnDirection == TURN_RIGHT)
-        {
-            turnPoint = INTERSECTION_Y + LANE_WIDTH / 4;
-        }
-        else
-        {
-            turnPoint = INTERSECTION_Y;
-        }
-        break;
-    case DIRECTION_SOUTH:
-        stopLine = INTERSECTION_Y - LANE_WIDTH - 40;
-        if (vehicle->turnDirection == TURN_LEFT)
-        {
-            turnPoint = INTERSECTION_Y + LANE_WIDTH / 4;
-        }
-        else if (vehicle->turnDirection == TURN_RIGHT)
-        {
-            turnPoint = INTERSECTION_Y - LANE_WIDTH / 4;
-        }
-        else
-        {
-            turnPoint = INTERSECTION_Y;
-        }
-        break;
-    case DIRECTION_EAST:
-        stopLine = INTERSECTION_X - LANE_WIDTH - 40;
-        if (vehicle->turnDirection == TURN_LEFT)
-        {
-            turnPoint = INTERSECTION_X + LANE_WIDTH / 4;
-        }
-        else if (vehicle->turnDirection == TURN_RIGHT)
-        {
-            turnPoint = INTERSECTION_X - LANE_WIDTH / 4;
-        }
-        else
-        {
-            turnPoint = INTERSECTION_X;
-        }
-        break;
-    case DIRECTION_WEST:
-        stopLine = INTERSECTION_X + LANE_WIDTH + 40;
-        if (vehicle->turnDirection == TURN_LEFT)
-        {
-            turnPoint = INTERSECTION_X - LANE_WIDTH / 4;
-        }
-        else if (vehicle->turnDirection == TURN_RIGHT)
-        {
-            turnPoint = INTERSECTION_X + LANE_WIDTH / 4;
-        }
-        else
-        {
-            turnPoint = INTERSECTION_X;
-        }
-        break;
+        rect.w = VEHICLE_WIDTH;
+        rect.h = VEHICLE_LENGTH;
     }
+    return rect;
+}
 
-    // Check if vehicle should stop based on traffic lights
-    if (!hasEmergencyPriority)
-    {
-        switch (vehicle->direction)
-        {
-        case DIRECTION_NORTH:
-            shouldStop = (vehicle->y > stopLine - stopDistance) &&
-                         (vehicle->y < stopLine) &&
-                         lights[DIRECTION_NORTH].state == RED;
-            break;
-        case DIRECTION_SOUTH:
-            shouldStop = (vehicle->y < stopLine + stopDistance) &&
-                         (vehicle->y > stopLine) &&
-                         lights[DIRECTION_SOUTH].state == RED;
-            break;
-        case DIRECTION_EAST:
-            shouldStop = (vehicle->x < stopLine + stopDistance) &&
-                         (vehicle->x > stopLine) &&
-                         lights[DIRECTION_EAST].state == RED;
-            break;
-        case DIRECTION_WEST:
-            shouldStop = (vehicle->x > stopLine - stopDistance) &&
-                         (vehicle->x < stopLine) &&
-                         lights[DIRECTION_WEST].state == RED;
-            break;
-        }
-    }
+// Built when drawing instead of being stored and kept in sync by every update
+SDL_Rect vehicleRect(const Vehicle *vehicle)
+{
+    return vehicleFootprint((Direction)vehicle->direction, vehicle->x, vehicle->y);
+}
 
-    // Update vehicle state based on stopping conditions
-    if (shouldStop)
-    {
-        vehicle->state = STATE_STOPPING;
-        vehicle->speed *= 0.8f; // Increased deceleration
-        if (vehicle->speed < 0.1f)
-        {
-            vehicle->state = STATE_STOPPED;
-            vehicle->speed = 0;
-        }
-    }
-    else if (vehicle->state == STATE_STOPPED && !shouldStop)
-    {
-        vehicle->state = STATE_MOVING;
-        // Reset speed based on vehicle type
-        switch (vehicle->type)
-        {
-        case AMBULANCE:
-        case POLICE_CAR:
-            vehicle->speed = 4.0f;
-            break;
-        case FIRE_TRUCK:
-            vehicle->speed = 3.5f;
-            break;
-        default:
-            vehicle->speed = 2.0f;
-        }
-    }
+void updateVehicle(Vehicle *vehicle)
+{
+    updateVehicleRef(vehicleRef(vehicle));
+}
 
-    // Decrease speed as vehicle approaches turn point
-    if (vehicle->state == STATE_MOVING && vehicle->turnDirection != TURN_NONE)
-    {
-        float distanceToTurnPoint = 0;
-        switch (vehicle->direction)
-        {
-        case DIRECTION_NORTH:
-        case DIRECTION_SOUTH:
-            distanceToTurnPoint = fabs(vehicle->y - turnPoint);
-            break;
-        case DIRECTION_EAST:
-        case DIRECTION_WEST:
-            distanceToTurnPoint = fabs(vehicle->x - turnPoint);
-            break;
-        }
+void updateVehicleRef(VehicleRef vehicle)
+{
+    if (!*vehicle.active)
+        return;
 
-        if (distanceToTurnPoint < stopDistance)
-        {
-            vehicle->speed *= 1.0f;
-            if (vehicle->speed < 0.5f)
-            {
-                vehicle->speed = 0.5f;
-            }
-        }
-    }
+    const DirectionGeometry *geometry = &DIRECTION_GEOMETRY[*vehicle.direction];
+    const TurnPath *turnPath = &turnPaths[*vehicle.direction][*vehicle.turnDirection][*vehicle.isInRightLane ? 1 : 0];
+    float *along = geometry->axis == AXIS_X ? vehicle.x : vehicle.y;
+    float sign = geometry->sign;
 
     // Check if at turning point
-    bool atTurnPoint = false;
-    switch (vehicle->direction)
-    {
-    case DIRECTION_NORTH:
-        atTurnPoint = vehicle->y <= turnPoint;
-        break;
-    case DIRECTION_SOUTH:
-        atTurnPoint = vehicle->y >= turnPoint;
-        break;
-    case DIRECTION_EAST:
-        atTurnPoint = vehicle->x >= turnPoint;
-        break;
-    case DIRECTION_WEST:
-        atTurnPoint = vehicle->x <= turnPoint;
-        break;
-    }
+    bool atTurnPoint = (*along - turnPath->start) * sign >= 0;
 
     // Start turning if at turn point
-    if (atTurnPoint && vehicle->turnDirection != TURN_NONE &&
-        vehicle->state != STATE_TURNING && vehicle->state != STATE_STOPPED)
+    if (atTurnPoint && *vehicle.turnDirection != TURN_NONE &&
+        *vehicle.state != STATE_TURNING && *vehicle.state != STATE_STOPPED)
     {
-        vehicle->state = STATE_TURNING;
-        vehicle->turnAngle = 0.0f;
-        vehicle->turnProgress = 0.0f;
+        *vehicle.state = STATE_TURNING;
+        *vehicle.turnAngle = 0.0f;
+        *vehicle.turnProgress = 0.0f;
+        *along = turnPath->start; // snap so the path ends exactly on the exit lane
     }
 
     // Movement logic
-    float moveSpeed = vehicle->speed;
-    if (vehicle->state == STATE_MOVING || vehicle->state == STATE_STOPPING)
+    float moveSpeed = *vehicle.speed;
+    if (*vehicle.state == STATE_MOVING || *vehicle.state == STATE_STOPPING)
     {
-        switch (vehicle->direction)
-        {
-        case DIRECTION_NORTH:
-            vehicle->y -= moveSpeed;
-            break;
-        case DIRECTION_SOUTH:
-            vehicle->y += moveSpeed;
-            break;
-        case DIRECTION_EAST:
-            vehicle->x += moveSpeed;
-            break;
-        case DIRECTION_WEST:
-            vehicle->x -= moveSpeed;
-            break;
-        }
+        *along += sign * moveSpeed;
     }
-    else if (vehicle->state == STATE_TURNING)
+    else if (*vehicle.state == STATE_TURNING)
     {
-        // Calculate turn angle based on vehicle type
-        float turnSpeed = 1.0f;
-        switch (vehicle->type)
-        {
-        case AMBULANCE:
-        case POLICE_CAR:
-            turnSpeed = 2.0f;
-            break;
-        case FIRE_TRUCK:
-            turnSpeed = 1.5f;
-            break;
-        default:
-            turnSpeed = 1.0f;
-        }
-
-        vehicle->turnAngle += turnSpeed;
-        vehicle->turnProgress = vehicle->turnAngle / 90.0f;
-        if (vehicle->turnAngle >= 90.0f)
-        {
-            vehicle->state = STATE_MOVING;
-            vehicle->turnAngle = 0.0f;
-            vehicle->turnProgress = 0.0f;
-            vehicle->isInRightLane = !vehicle->isInRightLane;
-        }
-
-        // Calculate new position based on turn angle
-        float turnRadius = 0.5f;
-        float turnCenterX = 0;
-        float turnCenterY = 0;
-        float turnCenter = 15;
-        switch (vehicle->direction)
+        // Advance along the precomputed path at the vehicle's own speed and
+        // move by the difference between the two path points
+        float previous = *vehicle.turnProgress;
+        float progress = previous + moveSpeed;
+        if (progress > turnPath->length)
         {
-        case DIRECTION_NORTH:
-            turnCenterX = vehicle->x + (vehicle->isInRightLane ? turnCenter : -turnCenter);
-            turnCenterY = vehicle->y;
-            ;
-            break;
-        case DIRECTION_SOUTH:
-            turnCenterX = vehicle->x + (vehicle->isInRightLane ? -turnCenter : turnCenter);
-            turnCenterY = vehicle->y;
-            break;
-        case DIRECTION_EAST:
-            turnCenterX = vehicle->x;
-            turnCenterY = vehicle->y + (!vehicle->isInRightLane ? turnCenter : -turnCenter);
-            break;
-        case DIRECTION_WEST:
-            turnCenterX = vehicle->x;
-            turnCenterY = vehicle->y + (!vehicle->isInRightLane ? -turnCenter : turnCenter);
-            break;
+            progress = turnPath->length;
         }
+        float fromX, fromY, toX, toY;
+        turnPathOffset(turnPath, previous, &fromX, &fromY);
+        turnPathOffset(turnPath, progress, &toX, &toY);
+        *vehicle.x += toX - fromX;
+        *vehicle.y += toY - fromY;
+        *vehicle.turnProgress = progress;
+        *vehicle.turnAngle = 90.0f * progress / turnPath->length;
 
-        float radians = vehicle->turnAngle * M_PI / 180.0f;
-        switch (vehicle->direction)
+        // Done: carry on straight in the exit direction
+        if (progress >= turnPath->length)
         {
-        case DIRECTION_NORTH:
-            vehicle->x = turnCenterX + turnRadius * sin(radians);
-            vehicle->y = turnCenterY - turnRadius * cos(radians);
-            break;
-        case DIRECTION_SOUTH:
-            vehicle->x = turnCenterX - turnRadius * sin(radians);
-            vehicle->y = turnCenterY + turnRadius * cos(radians);
-            break;
-        case DIRECTION_EAST:
-            vehicle->x = turnCenterX + turnRadius * cos(radians);
-            vehicle->y = turnCenterY + turnRadius * sin(radians);
-            break;
-        case DIRECTION_WEST:
-            vehicle->x = turnCenterX - turnRadius * cos(radians);
-            vehicle->y = turnCenterY - turnRadius * sin(radians);
-            break;
+            Direction exitDirection = TURN_EXIT_DIRECTION[*vehicle.direction][*vehicle.turnDirection];
+            *vehicle.direction = exitDirection;
+            *vehicle.turnDirection = TURN_NONE;
+            *vehicle.state = STATE_MOVING;
+            *vehicle.turnAngle = 0.0f;
+            *vehicle.turnProgress = 0.0f;
+            *vehicle.isInRightLane = DIRECTION_GEOMETRY[exitDirection].axis == AXIS_X
+                                         ? *vehicle.y > INTERSECTION_Y
+                                         : *vehicle.x > INTERSECTION_X;
         }
     }
 
-    // Update rectangle position
-    vehicle->rect.x = (int)vehicle->x;
-    vehicle->rect.y = (int)vehicle->y;
-
     // Check if vehicle has left the screen
-    if (vehicle->x < -100 || vehicle->x > WINDOW_WIDTH + 100 ||
-        vehicle->y < -100 || vehicle->y > WINDOW_HEIGHT + 100)
+    if (*vehicle.x < -100 || *vehicle.x > WINDOW_WIDTH + 100 ||
+        *vehicle.y < -100 || *vehicle.y > WINDOW_HEIGHT + 100)
     {
-        vehicle->active = false;
+        *vehicle.active = false;
     }
 }
 
+// True once the vehicle is beyond the zone where it would stop for a red light
+bool hasPassedStopLine(Direction direction, float x, float y)
+{
+    const DirectionGeometry *geometry = &DIRECTION_GEOMETRY[direction];
+    float along = geometry->axis == AXIS_X ? x : y;
+    return (along - geometry->intersectionEdge) * geometry->sign >= 0;
+}
+
+int laneQueueIndex(Direction direction, bool isInRightLane)
+{
+    return LANE_QUEUE_INDEX(direction, isInRightLane ? 1 : 0);
+}
+
+#ifndef SIM_HEADLESS
 // Enhanced road rendering with texture effect
 void renderRoads(SDL_Renderer *renderer)
 {
@@ -655,20 +632,22 @@ void renderVehicle(SDL_Renderer *renderer, Vehicle *vehicle)
     if (!vehicle->active)
         return;
     
+    SDL_Rect rect = vehicleRect(vehicle);
+
     // Base vehicle color
     SDL_Color baseColor = VEHICLE_COLORS[vehicle->type];
     
     // Draw the main vehicle body
     SDL_SetRenderDrawColor(renderer, baseColor.r, baseColor.g, baseColor.b, baseColor.a);
-    SDL_RenderFillRect(renderer, &vehicle->rect);
+    SDL_RenderFillRect(renderer, &rect);
     
     // Add vehicle details based on type
     int detailPadding = 2;
     SDL_Rect detailRect = {
-        vehicle->rect.x + detailPadding,
-        vehicle->rect.y + detailPadding,
-        vehicle->rect.w - detailPadding * 2,
-        vehicle->rect.h - detailPadding * 2
+        rect.x + detailPadding,
+        rect.y + detailPadding,
+        rect.w - detailPadding * 2,
+        rect.h - detailPadding * 2
     };
     
     // Add vehicle type-specific details
@@ -677,10 +656,10 @@ void renderVehicle(SDL_Renderer *renderer, Vehicle *vehicle)
             // White cross for ambulance
             SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
             if (vehicle->direction == DIRECTION_NORTH || vehicle->direction == DIRECTION_SOUTH) {
-                int crossW = vehicle->rect.w / 3;
-                int crossH = vehicle->rect.h / 2;
-                int crossX = vehicle->rect.x + (vehicle->rect.w - crossW) / 2;
-                int crossY = vehicle->rect.y + (vehicle->rect.h - crossH) / 2;
+                int crossW = rect.w / 3;
+                int crossH = rect.h / 2;
+                int crossX = rect.x + (rect.w - crossW) / 2;
+                int crossY = rect.y + (rect.h - crossH) / 2;
                 
                 SDL_Rect verticalBar = {
                     crossX + crossW/2 - 2,
@@ -697,10 +676,10 @@ void renderVehicle(SDL_Renderer *renderer, Vehicle *vehicle)
                 SDL_RenderFillRect(renderer, &verticalBar);
                 SDL_RenderFillRect(renderer, &horizontalBar);
             } else {
-                int crossW = vehicle->rect.w / 2;
-                int crossH = vehicle->rect.h / 3;
-                int crossX = vehicle->rect.x + (vehicle->rect.w - crossW) / 2;
-                int crossY = vehicle->rect.y + (vehicle->rect.h - crossH) / 2;
+                int crossW = rect.w / 2;
+                int crossH = rect.h / 3;
+                int crossX = rect.x + (rect.w - crossW) / 2;
+                int crossY = rect.y + (rect.h - crossH) / 2;
                 
                 SDL_Rect verticalBar = {
                     crossX + crossW/2 - 2,
@@ -723,37 +702,37 @@ void renderVehicle(SDL_Renderer *renderer, Vehicle *vehicle)
             // Blue/red stripe for police car
             if (vehicle->direction == DIRECTION_NORTH || vehicle->direction == DIRECTION_SOUTH) {
                 SDL_Rect redStripe = {
-                    vehicle->rect.x,
-                    vehicle->rect.y + vehicle->rect.h / 4,
-                    vehicle->rect.w,
-                    vehicle->rect.h / 8
+                    rect.x,
+                    rect.y + rect.h / 4,
+                    rect.w,
+                    rect.h / 8
                 };
                 SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
                 SDL_RenderFillRect(renderer, &redStripe);
                 
                 SDL_Rect blueStripe = {
-                    vehicle->rect.x,
-                    vehicle->rect.y + vehicle->rect.h / 4 + vehicle->rect.h / 8,
-                    vehicle->rect.w,
-                    vehicle->rect.h / 8
+                    rect.x,
+                    rect.y + rect.h / 4 + rect.h / 8,
+                    rect.w,
+                    rect.h / 8
                 };
                 SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255);
                 SDL_RenderFillRect(renderer, &blueStripe);
             } else {
                 SDL_Rect redStripe = {
-                    vehicle->rect.x + vehicle->rect.w / 4,
-                    vehicle->rect.y,
-                    vehicle->rect.w / 8,
-                    vehicle->rect.h
+                    rect.x + rect.w / 4,
+                    rect.y,
+                    rect.w / 8,
+                    rect.h
                 };
                 SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
                 SDL_RenderFillRect(renderer, &redStripe);
                 
                 SDL_Rect blueStripe = {
-                    vehicle->rect.x + vehicle->rect.w / 4 + vehicle->rect.w / 8,
-                    vehicle->rect.y,
-                    vehicle->rect.w / 8,
-                    vehicle->rect.h
+                    rect.x + rect.w / 4 + rect.w / 8,
+                    rect.y,
+                    rect.w / 8,
+                    rect.h
                 };
                 SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255);
                 SDL_RenderFillRect(renderer, &blueStripe);
@@ -764,19 +743,19 @@ void renderVehicle(SDL_Renderer *renderer, Vehicle *vehicle)
             // Yellow stripe for fire truck
             if (vehicle->direction == DIRECTION_NORTH || vehicle->direction == DIRECTION_SOUTH) {
                 SDL_Rect stripe = {
-                    vehicle->rect.x,
-                    vehicle->rect.y + vehicle->rect.h / 3,
-                    vehicle->rect.w,
-                    vehicle->rect.h / 6
+                    rect.x,
+                    rect.y + rect.h / 3,
+                    rect.w,
+                    rect.h / 6
                 };
                 SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
                 SDL_RenderFillRect(renderer, &stripe);
             } else {
                 SDL_Rect stripe = {
-                    vehicle->rect.x + vehicle->rect.w / 3,
-                    vehicle->rect.y,
-                    vehicle->rect.w / 6,
-                    vehicle->rect.h
+                    rect.x + rect.w / 3,
+                    rect.y,
+                    rect.w / 6,
+                    rect.h
                 };
                 SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
                 SDL_RenderFillRect(renderer, &stripe);
@@ -789,34 +768,34 @@ void renderVehicle(SDL_Renderer *renderer, Vehicle *vehicle)
             
             if (vehicle->direction == DIRECTION_NORTH || vehicle->direction == DIRECTION_SOUTH) {
                 SDL_Rect windshield = {
-                    vehicle->rect.x + 3,
-                    vehicle->rect.y + 3,
-                    vehicle->rect.w - 6,
-                    vehicle->rect.h / 3
+                    rect.x + 3,
+                    rect.y + 3,
+                    rect.w - 6,
+                    rect.h / 3
                 };
                 SDL_RenderFillRect(renderer, &windshield);
                 
                 SDL_Rect rearWindow = {
-                    vehicle->rect.x + 3,
-                    vehicle->rect.y + vehicle->rect.h - vehicle->rect.h / 3 - 3,
-                    vehicle->rect.w - 6,
-                    vehicle->rect.h / 3 - 3
+                    rect.x + 3,
+                    rect.y + rect.h - rect.h / 3 - 3,
+                    rect.w - 6,
+                    rect.h / 3 - 3
                 };
                 SDL_RenderFillRect(renderer, &rearWindow);
             } else {
                 SDL_Rect windshield = {
-                    vehicle->rect.x + 3,
-                    vehicle->rect.y + 3,
-                    vehicle->rect.w / 3,
-                    vehicle->rect.h - 6
+                    rect.x + 3,
+                    rect.y + 3,
+                    rect.w / 3,
+                    rect.h - 6
                 };
                 SDL_RenderFillRect(renderer, &windshield);
                 
                 SDL_Rect rearWindow = {
-                    vehicle->rect.x + vehicle->rect.w - vehicle->rect.w / 3 - 3,
-                    vehicle->rect.y + 3,
-                    vehicle->rect.w / 3 - 3,
-                    vehicle->rect.h - 6
+                    rect.x + rect.w - rect.w / 3 - 3,
+                    rect.y + 3,
+                    rect.w / 3 - 3,
+                    rect.h - 6
                 };
                 SDL_RenderFillRect(renderer, &rearWindow);
             }
@@ -831,23 +810,23 @@ void renderVehicle(SDL_Renderer *renderer, Vehicle *vehicle)
         baseColor.a);
     
     SDL_Rect bottomEdge = {
-        vehicle->rect.x,
-        vehicle->rect.y + vehicle->rect.h - 2,
-        vehicle->rect.w,
+        rect.x,
+        rect.y + rect.h - 2,
+        rect.w,
         2
     };
     SDL_Rect rightEdge = {
-        vehicle->rect.x + vehicle->rect.w - 2,
-        vehicle->rect.y,
+        rect.x + rect.w - 2,
+        rect.y,
         2,
-        vehicle->rect.h
+        rect.h
     };
     
     SDL_RenderFillRect(renderer, &bottomEdge);
     SDL_RenderFillRect(renderer, &rightEdge);
 }
 
-void renderSimulation(SDL_Renderer *renderer, Vehicle *vehicles, TrafficLight *lights, Statistics *stats)
+void renderSimulation(SDL_Renderer *renderer, const VehicleStore *store, TrafficLight *lights, Statistics *stats)
 {
     // Draw background
     SDL_SetRenderDrawColor(renderer, BACKGROUND_COLOR.r, BACKGROUND_COLOR.g, BACKGROUND_COLOR.b, BACKGROUND_COLOR.a);
@@ -863,12 +842,11 @@ void renderSimulation(SDL_Renderer *renderer, Vehicle *vehicles, TrafficLight *l
     }
 
     // Render enhanced vehicles
-    for (int i = 0; i < MAX_VEHICLES; i++)
+    for (int i = 0; i < store->activeCount; i++)
     {
-        if (vehicles[i].active)
-        {
-            renderVehicle(renderer, &vehicles[i]);
-        }
+        Vehicle vehicle;
+        vehicleStoreGet(store, i, &vehicle);
+        renderVehicle(renderer, &vehicle);
     }
 
     // Render queue display
@@ -877,18 +855,290 @@ void renderSimulation(SDL_Renderer *renderer, Vehicle *vehicles, TrafficLight *l
     // Present the rendered frame
     SDL_RenderPresent(renderer);
 }
+#endif
 
 // Queue functions
-void initQueue(Queue *q)
+#if defined(QUEUE_MPSC)
+bool initQueue(Queue *q)
+{
+    return initMpscQueue(q, MPSC_QUEUE_DEFAULT_CAPACITY);
+}
+
+bool enqueue(Queue *q, VehicleHandle handle, unsigned int *ticket)
+{
+    return mpscEnqueue(q, handle, ticket);
+}
+
+VehicleHandle dequeue(Queue *q)
+{
+    VehicleHandle handle;
+    return mpscDrain(q, &handle, 1) == 1 ? handle : INVALID_VEHICLE_HANDLE;
+}
+
+int isQueueEmpty(Queue *q)
+{
+    return mpscPeek(q, mpscHead(q)) == INVALID_VEHICLE_HANDLE;
+}
+
+int queueSize(const Queue *q)
+{
+    return mpscQueueSize(q);
+}
+
+int enqueueN(Queue *q, const VehicleHandle *handles, int count, unsigned int *firstTicket)
+{
+    return mpscEnqueueN(q, handles, count, firstTicket);
+}
+
+int dequeueN(Queue *q, VehicleHandle *out, int maxCount)
+{
+    return mpscDrain(q, out, maxCount);
+}
+
+VehicleHandle queueFront(const Queue *q)
+{
+    return mpscPeek(q, mpscHead(q));
+}
+
+VehicleHandle queueBack(const Queue *q)
+{
+    return queuePeekAt(q, mpscQueueSize(q) - 1);
+}
+
+// Positions still being written by a producer read as INVALID_VEHICLE_HANDLE
+VehicleHandle queuePeekAt(const Queue *q, int k)
+{
+    if (k < 0 || k >= mpscQueueSize(q))
+    {
+        return INVALID_VEHICLE_HANDLE;
+    }
+    return mpscPeek(q, mpscHead(q) + (unsigned int)k);
+}
+
+unsigned int queueHeadTicket(const Queue *q)
+{
+    return mpscHead(q);
+}
+
+int queuePositionOf(const Queue *q, unsigned int ticket)
+{
+    return (int)(ticket - mpscHead(q));
+}
+
+// Only for published entries; a slot a producer is still writing is left alone
+bool queueReplace(Queue *q, unsigned int ticket, VehicleHandle handle)
+{
+    if (queuePositionOf(q, ticket) < 0 || queuePositionOf(q, ticket) >= mpscQueueSize(q) ||
+        mpscPeek(q, ticket) == INVALID_VEHICLE_HANDLE)
+    {
+        return false;
+    }
+    q->slots[ticket & (q->capacity - 1)].handle = handle;
+    return true;
+}
+
+QueueIterator queueBegin(const Queue *q)
+{
+    QueueIterator it = {q, mpscHead(q)};
+    return it;
+}
+
+// Stops at the first handle not published yet
+bool queueNext(QueueIterator *it, VehicleHandle *handle)
+{
+    VehicleHandle next = mpscPeek(it->queue, it->index);
+    if (next == INVALID_VEHICLE_HANDLE)
+    {
+        return false;
+    }
+    *handle = next;
+    it->index++;
+    return true;
+}
+
+void destroyQueue(Queue *q)
+{
+    freeMpscQueue(q);
+}
+
+void freeQueueNodePool(void)
+{
+    // Lock-free queues own their slots; there is no shared node pool
+}
+#elif defined(QUEUE_RING_BUFFER)
+bool initQueue(Queue *q)
+{
+    return initRingQueue(q, RING_QUEUE_DEFAULT_CAPACITY, true);
+}
+
+bool enqueue(Queue *q, VehicleHandle handle, unsigned int *ticket)
+{
+    unsigned int tail = q->tail;
+    if (!ringEnqueue(q, handle))
+    {
+        return false;
+    }
+    if (ticket != NULL)
+    {
+        *ticket = tail;
+    }
+    return true;
+}
+
+VehicleHandle dequeue(Queue *q)
+{
+    return ringDequeue(q);
+}
+
+int isQueueEmpty(Queue *q)
+{
+    return isRingQueueEmpty(q);
+}
+
+int queueSize(const Queue *q)
+{
+    return q->size;
+}
+
+int enqueueN(Queue *q, const VehicleHandle *handles, int count, unsigned int *firstTicket)
+{
+    if (firstTicket != NULL)
+    {
+        *firstTicket = q->tail;
+    }
+    return ringEnqueueN(q, handles, count);
+}
+
+int dequeueN(Queue *q, VehicleHandle *out, int maxCount)
+{
+    return ringDequeueN(q, out, maxCount);
+}
+
+VehicleHandle queueFront(const Queue *q)
+{
+    return queuePeekAt(q, 0);
+}
+
+VehicleHandle queueBack(const Queue *q)
+{
+    return queuePeekAt(q, q->size - 1);
+}
+
+VehicleHandle queuePeekAt(const Queue *q, int k)
+{
+    if (k < 0 || k >= q->size)
+    {
+        return INVALID_VEHICLE_HANDLE;
+    }
+    return q->items[(q->head + k) & (q->capacity - 1)];
+}
+
+unsigned int queueHeadTicket(const Queue *q)
+{
+    return q->head;
+}
+
+int queuePositionOf(const Queue *q, unsigned int ticket)
+{
+    return (int)(ticket - q->head);
+}
+
+bool queueReplace(Queue *q, unsigned int ticket, VehicleHandle handle)
+{
+    int k = queuePositionOf(q, ticket);
+    if (k < 0 || k >= q->size)
+    {
+        return false;
+    }
+    q->items[ticket & (q->capacity - 1)] = handle;
+    return true;
+}
+
+QueueIterator queueBegin(const Queue *q)
+{
+    QueueIterator it = {q, q->head};
+    return it;
+}
+
+bool queueNext(QueueIterator *it, VehicleHandle *handle)
+{
+    if (it->index == it->queue->tail)
+    {
+        return false;
+    }
+    *handle = it->queue->items[it->index & (it->queue->capacity - 1)];
+    it->index++;
+    return true;
+}
+
+void destroyQueue(Queue *q)
+{
+    freeRingQueue(q);
+}
+
+void freeQueueNodePool(void)
+{
+    // Ring buffer queues own their storage; there is no shared node pool
+}
+#else
+// Nodes are carved out of slabs and recycled through an intrusive free list,
+// so steady-state enqueue/dequeue never reach malloc/free
+#define NODE_SLAB_SIZE 256
+
+typedef struct NodeSlab {
+    struct NodeSlab* next;
+    Node nodes[NODE_SLAB_SIZE];
+} NodeSlab;
+
+static NodeSlab *nodeSlabs = NULL;
+static Node *freeNodes = NULL;
+
+static Node *allocNode(void)
+{
+    if (freeNodes == NULL)
+    {
+        NodeSlab *slab = (NodeSlab *)malloc(sizeof(NodeSlab));
+        if (slab == NULL)
+        {
+            return NULL;
+        }
+        slab->next = nodeSlabs;
+        nodeSlabs = slab;
+        for (int i = 0; i < NODE_SLAB_SIZE - 1; i++)
+        {
+            slab->nodes[i].next = &slab->nodes[i + 1];
+        }
+        slab->nodes[NODE_SLAB_SIZE - 1].next = NULL;
+        freeNodes = &slab->nodes[0];
+    }
+    Node *node = freeNodes;
+    freeNodes = node->next;
+    return node;
+}
+
+static void releaseNode(Node *node)
+{
+    node->next = freeNodes;
+    freeNodes = node;
+}
+
+// Nodes come from the shared pool on enqueue, so there is nothing to allocate
+bool initQueue(Queue *q)
 {
     q->front = q->rear = NULL;
     q->size = 0;
+    q->headTicket = q->tailTicket = 0;
+    return true;
 }
 
-void enqueue(Queue *q, Vehicle vehicle)
+bool enqueue(Queue *q, VehicleHandle handle, unsigned int *ticket)
 {
-    Node *newNode = (Node *)malloc(sizeof(Node));
-    newNode->vehicle = vehicle;
+    Node *newNode = allocNode();
+    if (newNode == NULL)
+    {
+        return false;
+    }
+    newNode->handle = handle;
     newNode->next = NULL;
     if (q->rear == NULL)
     {
@@ -900,28 +1150,208 @@ void enqueue(Queue *q, Vehicle vehicle)
         q->rear = newNode;
     }
     q->size++;
+    if (ticket != NULL)
+    {
+        *ticket = q->tailTicket;
+    }
+    q->tailTicket++;
+    return true;
 }
 
-Vehicle dequeue(Queue *q)
+VehicleHandle dequeue(Queue *q)
 {
     if (q->front == NULL)
     {
-        Vehicle emptyVehicle = {0};
-        return emptyVehicle;
+        return INVALID_VEHICLE_HANDLE;
     }
     Node *temp = q->front;
-    Vehicle vehicle = temp->vehicle;
+    VehicleHandle handle = temp->handle;
     q->front = q->front->next;
     if (q->front == NULL)
     {
         q->rear = NULL;
     }
-    free(temp);
+    releaseNode(temp);
     q->size--;
-    return vehicle;
+    q->headTicket++;
+    return handle;
 }
 
 int isQueueEmpty(Queue *q)
 {
     return q->front == NULL;
-}
\ No newline at end of file
+}
+
+int queueSize(const Queue *q)
+{
+    return q->size;
+}
+
+// Link the whole batch first, then splice it onto the rear with one size update
+int enqueueN(Queue *q, const VehicleHandle *handles, int count, unsigned int *firstTicket)
+{
+    if (firstTicket != NULL)
+    {
+        *firstTicket = q->tailTicket;
+    }
+    Node *first = NULL;
+    Node *last = NULL;
+    int linked = 0;
+    while (linked < count)
+    {
+        Node *node = allocNode();
+        if (node == NULL)
+        {
+            break;
+        }
+        node->handle = handles[linked];
+        node->next = NULL;
+        if (last == NULL)
+        {
+            first = node;
+        }
+        else
+        {
+            last->next = node;
+        }
+        last = node;
+        linked++;
+    }
+    if (linked == 0)
+    {
+        return 0;
+    }
+
+    if (q->rear == NULL)
+    {
+        q->front = first;
+    }
+    else
+    {
+        q->rear->next = first;
+    }
+    q->rear = last;
+    q->size += linked;
+    q->tailTicket += linked;
+    return linked;
+}
+
+// Copy out up to maxCount handles, then return the consumed chain to the pool in one splice
+int dequeueN(Queue *q, VehicleHandle *out, int maxCount)
+{
+    Node *node = q->front;
+    Node *last = NULL;
+    int count = 0;
+    while (node != NULL && count < maxCount)
+    {
+        out[count++] = node->handle;
+        last = node;
+        node = node->next;
+    }
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    last->next = freeNodes;
+    freeNodes = q->front;
+    q->front = node;
+    if (q->front == NULL)
+    {
+        q->rear = NULL;
+    }
+    q->size -= count;
+    q->headTicket += count;
+    return count;
+}
+
+VehicleHandle queueFront(const Queue *q)
+{
+    return q->front != NULL ? q->front->handle : INVALID_VEHICLE_HANDLE;
+}
+
+VehicleHandle queueBack(const Queue *q)
+{
+    return q->rear != NULL ? q->rear->handle : INVALID_VEHICLE_HANDLE;
+}
+
+VehicleHandle queuePeekAt(const Queue *q, int k)
+{
+    if (k < 0 || k >= q->size)
+    {
+        return INVALID_VEHICLE_HANDLE;
+    }
+    const Node *node = q->front;
+    while (k-- > 0)
+    {
+        node = node->next;
+    }
+    return node->handle;
+}
+
+unsigned int queueHeadTicket(const Queue *q)
+{
+    return q->headTicket;
+}
+
+int queuePositionOf(const Queue *q, unsigned int ticket)
+{
+    return (int)(ticket - q->headTicket);
+}
+
+bool queueReplace(Queue *q, unsigned int ticket, VehicleHandle handle)
+{
+    int k = queuePositionOf(q, ticket);
+    if (k < 0 || k >= q->size)
+    {
+        return false;
+    }
+    Node *node = q->front;
+    while (k-- > 0)
+    {
+        node = node->next;
+    }
+    node->handle = handle;
+    return true;
+}
+
+QueueIterator queueBegin(const Queue *q)
+{
+    QueueIterator it = {q->front};
+    return it;
+}
+
+bool queueNext(QueueIterator *it, VehicleHandle *handle)
+{
+    if (it->node == NULL)
+    {
+        return false;
+    }
+    *handle = it->node->handle;
+    it->node = it->node->next;
+    return true;
+}
+
+// Splice the whole node chain back onto the free list in O(1)
+void destroyQueue(Queue *q)
+{
+    if (q->front != NULL)
+    {
+        q->rear->next = freeNodes;
+        freeNodes = q->front;
+    }
+    initQueue(q);
+}
+
+// Release every slab; only call once all queues have been destroyed
+void freeQueueNodePool(void)
+{
+    while (nodeSlabs != NULL)
+    {
+        NodeSlab *next = nodeSlabs->next;
+        free(nodeSlabs);
+        nodeSlabs = next;
+    }
+    freeNodes = NULL;
+}
+#endif
@@ -1,13 +1,14 @@
 #ifndef TRAFFIC_SIMULATION_H
 #define TRAFFIC_SIMULATION_H
 
-#include <SDL.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include "sim_platform.h"
 
 #define WINDOW_WIDTH 800
 #define WINDOW_HEIGHT 600
 #define LANE_WIDTH 80
-#define MAX_VEHICLES 10
+#define LANES_PER_DIRECTION 2
 #define INTERSECTION_X (WINDOW_WIDTH / 2)
 #define INTERSECTION_Y (WINDOW_HEIGHT / 2)
 
@@ -45,20 +46,129 @@ typedef enum {
 #define TRAFFIC_LIGHT_HEIGHT (LANE_WIDTH - LANE_WIDTH / 3)
 #define STOP_LINE_WIDTH 5
 
+typedef enum {
+    AXIS_X,
+    AXIS_Y
+} Axis;
+
+// Geometry of one approach. A vehicle moves along axis; sign is +1 when that
+// coordinate grows as it drives.
+typedef struct {
+    Axis axis;
+    float sign;
+    float intersectionEdge; // the stop line; crossing it means the vehicle is in the box
+} DirectionGeometry;
+
+extern const DirectionGeometry DIRECTION_GEOMETRY[4];
+
+// Distance of (x, y) along an approach's direction of travel; larger is
+// further ahead
+static inline float alongLane(const DirectionGeometry* geometry, float x, float y)
+{
+    return (geometry->axis == AXIS_Y ? y : x) * geometry->sign;
+}
+extern const Direction TURN_EXIT_DIRECTION[4][3];
+
+// Intelligent Driver Model parameters, by VehicleType. Distances are pixels
+// and times simulation ticks, so speeds are pixels per tick.
+typedef struct {
+    float desiredSpeed;        // v0: cruising speed on a free road
+    float maxAcceleration;     // a
+    float comfortDeceleration; // b
+    float minimumGap;          // s0: bumper-to-bumper distance kept when stopped
+    float timeHeadway;         // T: ticks of headway kept while moving
+} IdmParameters;
+
+extern const IdmParameters IDM_PARAMETERS[4];
+
+// Gap standing in for "nothing ahead"
+#define IDM_FREE_GAP 1.0e6f
+// Gaps are clamped to this so the interaction term stays finite
+#define IDM_MIN_GAP 0.5f
+// A vehicle that is not speeding up and would fall below this speed stops outright
+#define IDM_STOPPED_SPEED 0.05f
+// Slowing down by more than this per tick counts as braking (STATE_STOPPING);
+// a vehicle cruising at its desired speed has a tiny negative acceleration
+#define IDM_BRAKING_THRESHOLD 0.01f
+
+// Per-tick speed change:
+//   a * (1 - (v / v0)^4 - (s* / s)^2),  s* = s0 + max(0, v T + v (v - vLeader) / (2 sqrt(a b)))
+// for a gap s to the leader (or red light) ahead driving at vLeader
+float idmAcceleration(const IdmParameters* params, float speed, float gap, float leaderSpeed);
+
+// Turning paths: a quarter circle from the entry lane onto the same lane of
+// the exit road, stored as a polyline of offsets from where the turn starts.
+// Every segment has the same length, so a vehicle's distance along the path
+// maps to a segment with one division and no trig.
+#define TURN_PATH_SEGMENTS 16
+#define TURN_RADIUS 30.0f
+
+typedef struct {
+    float start;  // coordinate along the entry axis where the turn begins
+    float dx[TURN_PATH_SEGMENTS + 1];
+    float dy[TURN_PATH_SEGMENTS + 1];
+    float segmentLength;
+    float length;
+} TurnPath;
+
+// Indexed [direction][turnDirection][lane]; the TURN_NONE entries are unused
+extern TurnPath turnPaths[4][3][LANES_PER_DIRECTION];
+
+// Vehicle footprint in pixels; the long side points along the direction of travel
+#define VEHICLE_LENGTH 30
+#define VEHICLE_WIDTH 20
+
+// Enums are stored in one byte each and the on-screen rect is derived from
+// x, y and direction only when drawing (vehicleRect), so a vehicle packs into
+// 32 bytes and the hot fields of the update loops (x, y, speed, direction,
+// turnDirection, state, active) into 16
 typedef struct {
-    SDL_Rect rect;
-    VehicleType type;
-    Direction direction;
-    TurnDirection turnDirection;
-    VehicleState state;
-    float speed;
     float x;
     float y;
+    float speed;
+    float turnAngle;      // degrees turned so far
+    float turnProgress;   // distance travelled along the turning path
+    uint8_t type;         // VehicleType
+    uint8_t direction;    // Direction
+    uint8_t turnDirection; // TurnDirection
+    uint8_t state;        // VehicleState
     bool active;
-    float turnAngle;  
     bool isInRightLane;
-    bool turnProgress;
+    bool inLaneQueue; // handle is held by a lane queue; the slot must not be reused yet
+    unsigned int queueTicket; // from enqueue; queuePositionOf turns it into a position
 } Vehicle;
+
+// Pointers to one vehicle's simulated fields, wherever they live (a Vehicle
+// struct or a VehicleStore slot), so the update logic is written once
+typedef struct {
+    float* x;
+    float* y;
+    float* speed;
+    float* turnAngle;
+    uint8_t* type;
+    uint8_t* direction;
+    uint8_t* turnDirection;
+    uint8_t* state;
+    bool* active;
+    bool* isInRightLane;
+    float* turnProgress;
+} VehicleRef;
+
+typedef struct VehicleStore VehicleStore;
+
+// Lane queues hold compact handles into the central vehicle store instead of
+// copies of Vehicle, so queue order and vehicle state cannot diverge.
+// Low 20 bits are the store slot, high 12 bits the slot's generation, which
+// changes every time the slot is released so stale handles can be detected.
+// A stale handle only matches again after its slot was reused 4096 times,
+// far longer than a lane queue, wait list or lane order keeps one.
+typedef uint32_t VehicleHandle;
+#define INVALID_VEHICLE_HANDLE 0xFFFFFFFFu
+#define VEHICLE_INDEX_BITS 20
+#define VEHICLE_GENERATION_MASK ((1u << (32 - VEHICLE_INDEX_BITS)) - 1)
+#define VEHICLE_HANDLE_INDEX(handle) ((int)((handle) & ((1u << VEHICLE_INDEX_BITS) - 1)))
+#define VEHICLE_HANDLE_GENERATION(handle) ((uint16_t)((handle) >> VEHICLE_INDEX_BITS))
+#define MAKE_VEHICLE_HANDLE(index, generation) (((VehicleHandle)(generation) << VEHICLE_INDEX_BITS) | (VehicleHandle)(index))
 typedef struct {
     TrafficLightState state;
     int timer;
@@ -70,12 +180,65 @@ typedef struct {
     int vehiclesPassed;
     int totalVehicles;
     float vehiclesPerMinute;
-    Uint32 startTime;
+    int conflicts; // vehicle pairs overlapping inside the intersection, summed over steps
+    Uint32 startTime; // simulated milliseconds
 } Statistics;
 
-// Queue data structure
+// Ring buffer queue: contiguous power-of-two storage, no allocation per vehicle
+#define RING_QUEUE_DEFAULT_CAPACITY 64
+
+typedef struct {
+    VehicleHandle* items;
+    unsigned int head;      // free-running read index
+    unsigned int tail;      // free-running write index
+    unsigned int capacity;  // always a power of two
+    int size;
+    bool growable;          // double the storage instead of rejecting when full
+} RingQueue;
+
+// Bounded lock-free queue for several concurrent spawners feeding one
+// simulation thread. Producers claim positions with a single CAS on tail and
+// never block; the consumer drains everything published so far in one batch
+// and publishes the new head with one atomic store per drain.
+#define MPSC_QUEUE_DEFAULT_CAPACITY 1024
+#define MPSC_CACHE_LINE_SIZE 64
+
+typedef struct {
+    SDL_atomic_t sequence; // position + 1 once the handle has been written
+    VehicleHandle handle;
+} MpscSlot;
+
+typedef struct {
+    MpscSlot* slots;
+    unsigned int capacity; // always a power of two
+    char padTail[MPSC_CACHE_LINE_SIZE];
+    SDL_atomic_t tail;     // next position to claim, shared by producers
+    char padHead[MPSC_CACHE_LINE_SIZE];
+    SDL_atomic_t head;     // next position to drain, written by the consumer only
+    char padEnd[MPSC_CACHE_LINE_SIZE];
+} MpscQueue;
+
+// Queue data structure. QUEUE_RING_BUFFER backs it with a RingQueue for O(1)
+// random access; QUEUE_MPSC with an MpscQueue, so any thread may enqueue
+// while everything else stays on the simulation thread; without either Queue
+// is a linked list with pointer-stable nodes. QUEUE_MPSC wins if both are set.
+#if defined(QUEUE_MPSC)
+typedef MpscQueue Queue;
+
+typedef struct {
+    const MpscQueue* queue;
+    unsigned int index;
+} QueueIterator;
+#elif defined(QUEUE_RING_BUFFER)
+typedef RingQueue Queue;
+
+typedef struct {
+    const RingQueue* queue;
+    unsigned int index;
+} QueueIterator;
+#else
 typedef struct Node {
-    Vehicle vehicle;
+    VehicleHandle handle;
     struct Node* next;
 } Node;
 
@@ -83,23 +246,97 @@ typedef struct {
     Node* front;
     Node* rear;
     int size;
+    unsigned int headTicket; // tickets dequeued so far
+    unsigned int tailTicket; // tickets handed out so far
 } Queue;
+
+typedef struct {
+    const Node* node;
+} QueueIterator;
+#endif
+// One queue per physical lane: two lanes per approach, stored approach by
+// approach so a single sweep over laneQueues visits every lane in order.
+// Lane 0 is the left/top lane, lane 1 the right/bottom one (isInRightLane).
+#define LANE_QUEUE_COUNT (4 * LANES_PER_DIRECTION)
+#define LANE_QUEUE_INDEX(direction, lane) ((direction) * LANES_PER_DIRECTION + (lane))
+#define LANE_QUEUE_DIRECTION(index) ((Direction)((index) / LANES_PER_DIRECTION))
+
 // Declare laneQueues as an external variable
-extern Queue laneQueues[4];
+extern Queue laneQueues[LANE_QUEUE_COUNT];
 
 // Function declarations
 void initializeTrafficLights(TrafficLight* lights);
-void updateTrafficLights(TrafficLight* lights);
+void initializeTurnPaths(void);
+// now: simulated milliseconds. Returns a bit (1 << direction) for every light
+// that turned green, so vehicles waiting on it can be woken.
+unsigned int updateTrafficLights(TrafficLight* lights, Uint32 now);
 Vehicle* createVehicle(Direction direction);
-void updateVehicle(Vehicle* vehicle, TrafficLight* lights);
-void renderSimulation(SDL_Renderer* renderer, Vehicle* vehicles, TrafficLight* lights, Statistics* stats);
+void updateVehicle(Vehicle* vehicle);
+VehicleRef vehicleRef(Vehicle* vehicle);
+SDL_Rect vehicleFootprint(Direction direction, float x, float y);
+SDL_Rect vehicleRect(const Vehicle* vehicle); // for drawing; not kept up to date in the core
+void updateVehicleRef(VehicleRef vehicle); // moves at the current speed; idm.h sets speeds
+bool hasPassedStopLine(Direction direction, float x, float y);
+int laneQueueIndex(Direction direction, bool isInRightLane);
+#ifndef SIM_HEADLESS
+void renderSimulation(SDL_Renderer* renderer, const VehicleStore* store, TrafficLight* lights, Statistics* stats);
 void renderRoads(SDL_Renderer* renderer);
 void renderQueues(SDL_Renderer* renderer);
+#endif
 
-// Queue functions
-void initQueue(Queue* q);
-void enqueue(Queue* q, Vehicle vehicle);
-Vehicle dequeue(Queue* q);
+// Queue functions. With QUEUE_MPSC, enqueue and enqueueN may be called from
+// any thread; the rest belong to the one consuming thread.
+bool initQueue(Queue* q); // false if its storage could not be allocated
+// false if the handle could not be queued; otherwise *ticket (may be NULL)
+// is the vehicle's queue ticket
+bool enqueue(Queue* q, VehicleHandle handle, unsigned int* ticket);
+VehicleHandle dequeue(Queue* q); // INVALID_VEHICLE_HANDLE when empty
 int isQueueEmpty(Queue* q);
+int queueSize(const Queue* q);
+// Returns how many of handles, from the first on, were queued; they got
+// consecutive tickets starting at *firstTicket (may be NULL)
+int enqueueN(Queue* q, const VehicleHandle* handles, int count, unsigned int* firstTicket);
+int dequeueN(Queue* q, VehicleHandle* out, int maxCount);        // returns how many were taken
+// Random access: O(1) with QUEUE_RING_BUFFER and QUEUE_MPSC, O(k) for the linked list
+VehicleHandle queueFront(const Queue* q);
+VehicleHandle queueBack(const Queue* q);
+VehicleHandle queuePeekAt(const Queue* q, int k); // k = 0 is the front
+// A ticket stays valid across enqueue/dequeue until its vehicle is dequeued
+unsigned int queueHeadTicket(const Queue* q);
+int queuePositionOf(const Queue* q, unsigned int ticket);
+// Overwrite the entry holding ticket in place; false once it has been dequeued
+bool queueReplace(Queue* q, unsigned int ticket, VehicleHandle handle);
+// Walk a lane's handles front to back without dequeuing
+QueueIterator queueBegin(const Queue* q);
+bool queueNext(QueueIterator* it, VehicleHandle* handle);
+void destroyQueue(Queue* q);
+void freeQueueNodePool(void);
+
+// Ring buffer queue functions
+// Returns false if the buffer could not be allocated; the queue is then
+// empty with capacity 0 (a growable one retries on its first enqueue)
+bool initRingQueue(RingQueue* q, unsigned int capacity, bool growable);
+bool ringEnqueue(RingQueue* q, VehicleHandle handle);
+VehicleHandle ringDequeue(RingQueue* q);
+int ringEnqueueN(RingQueue* q, const VehicleHandle* handles, int count);
+int ringDequeueN(RingQueue* q, VehicleHandle* out, int maxCount);
+int isRingQueueEmpty(RingQueue* q);
+void freeRingQueue(RingQueue* q);
+
+// Lock-free queue functions
+bool initMpscQueue(MpscQueue* q, unsigned int capacity); // false if the slots could not be allocated
+void freeMpscQueue(MpscQueue* q);
+// Any thread: return false / fewer than count without blocking when the
+// queue is full. position (may be NULL) receives the first claimed position.
+bool mpscEnqueue(MpscQueue* q, VehicleHandle handle, unsigned int* position);
+int mpscEnqueueN(MpscQueue* q, const VehicleHandle* handles, int count, unsigned int* position);
+// Consumer only: moves up to maxCount handles into out, oldest first
+int mpscDrain(MpscQueue* q, VehicleHandle* out, int maxCount);
+// Consumer only: handle at a position if it has been published, else
+// INVALID_VEHICLE_HANDLE
+VehicleHandle mpscPeek(const MpscQueue* q, unsigned int position);
+unsigned int mpscHead(const MpscQueue* q);
+// Approximate number of queued handles (claimed but maybe not yet published)
+int mpscQueueSize(const MpscQueue* q);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,235 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // shm_open, ftruncate, kill
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include "vehicle_channel.h"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CACHE_LINE_SIZE 64
+
+// head is only written by the consumer and tail only by the producer; keeping
+// them on separate cache lines stops the two processes bouncing one line
+struct VehicleChannelShared {
+    _Alignas(CACHE_LINE_SIZE) atomic_uint ready; // VEHICLE_CHANNEL_MAGIC while the producer is streaming
+    atomic_int producerPid;
+    _Alignas(CACHE_LINE_SIZE) atomic_uint head;
+    _Alignas(CACHE_LINE_SIZE) atomic_uint tail;
+    _Alignas(CACHE_LINE_SIZE) atomic_uint dropped;
+    _Alignas(CACHE_LINE_SIZE) VehicleRecord records[VEHICLE_CHANNEL_CAPACITY];
+};
+
+// The ready flag is published last with release ordering, after the ring
+// is initialized; the PID catches a producer that was killed before it
+// could clear the flag
+static bool producerAlive(VehicleChannelShared *shared)
+{
+    if (atomic_load_explicit(&shared->ready, memory_order_acquire) != VEHICLE_CHANNEL_MAGIC)
+    {
+        return false;
+    }
+    pid_t pid = (pid_t)atomic_load_explicit(&shared->producerPid, memory_order_relaxed);
+    return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+bool openVehicleChannel(VehicleChannel *channel, bool create)
+{
+    channel->shared = NULL;
+    channel->owner = create;
+
+    int fd;
+    if (create)
+    {
+        // A generator that was killed never unlinked its segment; start from
+        // a fresh one so no consumer can attach to a half-initialized ring
+        shm_unlink(VEHICLE_CHANNEL_NAME);
+        fd = shm_open(VEHICLE_CHANNEL_NAME, O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0)
+        {
+            perror("Failed to create vehicle channel");
+            return false;
+        }
+        if (ftruncate(fd, sizeof(VehicleChannelShared)) != 0)
+        {
+            perror("Failed to size vehicle channel");
+            close(fd);
+            shm_unlink(VEHICLE_CHANNEL_NAME);
+            return false;
+        }
+    }
+    else
+    {
+        fd = shm_open(VEHICLE_CHANNEL_NAME, O_RDWR, 0600);
+        if (fd < 0)
+        {
+            return false;
+        }
+        // Mapping past the end of a segment the producer has not sized yet
+        // (or a foreign one) would fault on first access
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(VehicleChannelShared))
+        {
+            close(fd);
+            return false;
+        }
+    }
+
+    void *memory = mmap(NULL, sizeof(VehicleChannelShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+    {
+        perror("Failed to map vehicle channel");
+        if (create)
+        {
+            shm_unlink(VEHICLE_CHANNEL_NAME);
+        }
+        return false;
+    }
+
+    VehicleChannelShared *shared = (VehicleChannelShared *)memory;
+    if (create)
+    {
+        atomic_init(&shared->head, 0);
+        atomic_init(&shared->tail, 0);
+        atomic_init(&shared->dropped, 0);
+        atomic_store_explicit(&shared->producerPid, (int)getpid(), memory_order_relaxed);
+        atomic_store_explicit(&shared->ready, VEHICLE_CHANNEL_MAGIC, memory_order_release);
+    }
+    else if (!producerAlive(shared))
+    {
+        fprintf(stderr, "Ignoring stale vehicle channel, no generator is running\n");
+        munmap(memory, sizeof(VehicleChannelShared));
+        return false;
+    }
+    channel->shared = shared;
+    return true;
+}
+
+void closeVehicleChannel(VehicleChannel *channel)
+{
+    if (channel->shared == NULL)
+    {
+        return;
+    }
+    if (channel->owner)
+    {
+        atomic_store_explicit(&channel->shared->ready, 0, memory_order_release);
+    }
+    munmap(channel->shared, sizeof(VehicleChannelShared));
+    if (channel->owner)
+    {
+        shm_unlink(VEHICLE_CHANNEL_NAME);
+    }
+    channel->shared = NULL;
+}
+
+bool vehicleChannelProducerAlive(const VehicleChannel *channel)
+{
+    return channel->shared != NULL && producerAlive(channel->shared);
+}
+
+bool pushVehicleRecord(VehicleChannel *channel, const Vehicle *vehicle)
+{
+    VehicleChannelShared *shared = channel->shared;
+    unsigned int tail = atomic_load_explicit(&shared->tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&shared->head, memory_order_acquire);
+
+    if (tail - head == VEHICLE_CHANNEL_CAPACITY)
+    {
+        atomic_fetch_add_explicit(&shared->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+
+    VehicleRecord *record = &shared->records[tail & (VEHICLE_CHANNEL_CAPACITY - 1)];
+    record->x = vehicle->x;
+    record->y = vehicle->y;
+    record->speed = vehicle->speed;
+    record->direction = (uint8_t)vehicle->direction;
+    record->type = (uint8_t)vehicle->type;
+    record->turnDirection = (uint8_t)vehicle->turnDirection;
+    record->isInRightLane = vehicle->isInRightLane;
+
+    atomic_store_explicit(&shared->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+int drainVehicleRecords(VehicleChannel *channel, Vehicle *out, int maxCount)
+{
+    VehicleChannelShared *shared = channel->shared;
+    unsigned int head = atomic_load_explicit(&shared->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&shared->tail, memory_order_acquire);
+
+    int count = (int)(tail - head);
+    if (count > maxCount)
+    {
+        count = maxCount;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        const VehicleRecord *record = &shared->records[(head + i) & (VEHICLE_CHANNEL_CAPACITY - 1)];
+        Vehicle *vehicle = &out[i];
+        memset(vehicle, 0, sizeof(Vehicle));
+        vehicle->x = record->x;
+        vehicle->y = record->y;
+        vehicle->speed = record->speed;
+        vehicle->direction = record->direction;
+        vehicle->type = record->type;
+        vehicle->turnDirection = record->turnDirection;
+        vehicle->isInRightLane = record->isInRightLane;
+        vehicle->state = STATE_MOVING;
+        vehicle->active = true;
+    }
+
+    atomic_store_explicit(&shared->head, head + count, memory_order_release);
+    return count;
+}
+
+uint32_t vehicleChannelDropped(VehicleChannel *channel)
+{
+    return atomic_load_explicit(&channel->shared->dropped, memory_order_relaxed);
+}
+
+#else
+// No POSIX shared memory: callers fall back to file/local spawning
+bool openVehicleChannel(VehicleChannel *channel, bool create)
+{
+    channel->shared = NULL;
+    channel->owner = create;
+    return false;
+}
+
+void closeVehicleChannel(VehicleChannel *channel)
+{
+    channel->shared = NULL;
+}
+
+bool vehicleChannelProducerAlive(const VehicleChannel *channel)
+{
+    return false;
+}
+
+bool pushVehicleRecord(VehicleChannel *channel, const Vehicle *vehicle)
+{
+    return false;
+}
+
+int drainVehicleRecords(VehicleChannel *channel, Vehicle *out, int maxCount)
+{
+    return 0;
+}
+
+uint32_t vehicleChannelDropped(VehicleChannel *channel)
+{
+    return 0;
+}
+#endif
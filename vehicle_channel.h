@@ -0,0 +1,55 @@
+#ifndef VEHICLE_CHANNEL_H
+#define VEHICLE_CHANNEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "traffic_simulation.h"
+
+// Shared-memory ring that carries vehicles from GeneratorApp to MainApp.
+// One producer (the generator) and one consumer (the simulator); the hot path
+// is plain loads/stores with acquire/release ordering, no syscalls.
+#define VEHICLE_CHANNEL_NAME "/traffic_vehicle_channel"
+#define VEHICLE_CHANNEL_CAPACITY 1024 // must be a power of two
+#define VEHICLE_CHANNEL_BATCH 64      // records drained per simulation tick
+// Written to the shared header once the producer has set the ring up, so a
+// consumer never trusts a segment that is stale or still being created
+#define VEHICLE_CHANNEL_MAGIC 0x56434831u // "VCH1"
+
+// Fixed-size record written into the ring
+typedef struct {
+    float x;
+    float y;
+    float speed;
+    uint8_t direction;
+    uint8_t type;
+    uint8_t turnDirection;
+    uint8_t isInRightLane;
+} VehicleRecord;
+
+typedef struct VehicleChannelShared VehicleChannelShared;
+
+typedef struct {
+    VehicleChannelShared* shared;
+    bool owner; // the creator unlinks the segment on close
+} VehicleChannel;
+
+// create = true for the producer, which replaces any segment a killed
+// generator left behind; false to attach to an existing channel, which only
+// succeeds while the producer that set it up is still running
+bool openVehicleChannel(VehicleChannel* channel, bool create);
+void closeVehicleChannel(VehicleChannel* channel);
+
+// Consumer side: false once the producer has closed the channel or exited,
+// after which nothing more will arrive
+bool vehicleChannelProducerAlive(const VehicleChannel* channel);
+
+// Producer side: returns false and counts a drop when the simulator falls behind
+bool pushVehicleRecord(VehicleChannel* channel, const Vehicle* vehicle);
+
+// Consumer side: copies up to maxCount vehicles out in one batch
+int drainVehicleRecords(VehicleChannel* channel, Vehicle* out, int maxCount);
+
+// Number of records rejected because the ring was full
+uint32_t vehicleChannelDropped(VehicleChannel* channel);
+
+#endif
@@ -0,0 +1,495 @@
+#include <math.h>
+#include <string.h>
+#include "vehicle_kernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define VEHICLE_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// Headless builds have no SDL to ask; GCC/Clang can query the CPU themselves,
+// other compilers only get the SSE2 baseline every x86-64 CPU has
+#ifdef SIM_HEADLESS
+#if defined(__GNUC__) || defined(__clang__)
+#define CPU_HAS_SSE2() __builtin_cpu_supports("sse2")
+#define CPU_HAS_AVX2() __builtin_cpu_supports("avx2")
+#elif defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CPU_HAS_SSE2() true
+#define CPU_HAS_AVX2() false
+#else
+#define CPU_HAS_SSE2() false
+#define CPU_HAS_AVX2() false
+#endif
+#else
+#define CPU_HAS_SSE2() SDL_HasSSE2()
+#define CPU_HAS_AVX2() SDL_HasAVX2()
+#endif
+
+// GCC/Clang need the ISA enabled per function so the rest of the build keeps
+// its baseline flags; MSVC accepts the intrinsics as is
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+// The SIMD kernels load active and the one-byte enum columns as bytes and
+// widen them to 32-bit lanes
+_Static_assert(sizeof(bool) == 1, "bool must be one byte wide");
+
+#define CULL_MARGIN 100.0f
+
+// Written so that it produces bit-identical results to updateVehicleRef for
+// TURN_NONE vehicles, using the same DIRECTION_GEOMETRY tables
+static void updateStraightScalar(VehicleStore *store, int begin, int end)
+{
+    for (int i = begin; i < end; i++)
+    {
+        if (!store->active[i] || store->turnDirection[i] != TURN_NONE)
+        {
+            continue;
+        }
+
+        const DirectionGeometry *geometry = &DIRECTION_GEOMETRY[store->direction[i]];
+        bool vertical = geometry->axis == AXIS_Y;
+        float pos = vertical ? store->y[i] : store->x[i];
+        if (store->state[i] == STATE_MOVING || store->state[i] == STATE_STOPPING)
+        {
+            pos += geometry->sign * store->speed[i];
+        }
+        if (vertical)
+        {
+            store->y[i] = pos;
+        }
+        else
+        {
+            store->x[i] = pos;
+        }
+
+        if (store->x[i] < -CULL_MARGIN || store->x[i] > WINDOW_WIDTH + CULL_MARGIN ||
+            store->y[i] < -CULL_MARGIN || store->y[i] > WINDOW_HEIGHT + CULL_MARGIN)
+        {
+            store->active[i] = false;
+        }
+    }
+}
+
+// Per-type IDM constants laid out for table lookups by VehicleType
+typedef struct {
+    float desiredSpeed[4];
+    float maxAcceleration[4];
+    float minimumGap[4];
+    float timeHeadway[4];
+    float brakingTerm[4]; // 2 sqrt(a b)
+} IdmTables;
+
+static IdmTables idmTables(void)
+{
+    IdmTables tables;
+    for (int type = 0; type < 4; type++)
+    {
+        const IdmParameters *params = &IDM_PARAMETERS[type];
+        tables.desiredSpeed[type] = params->desiredSpeed;
+        tables.maxAcceleration[type] = params->maxAcceleration;
+        tables.minimumGap[type] = params->minimumGap;
+        tables.timeHeadway[type] = params->timeHeadway;
+        tables.brakingTerm[type] = 2.0f * sqrtf(params->maxAcceleration * params->comfortDeceleration);
+    }
+    return tables;
+}
+
+static void updateIdmScalar(VehicleStore *store, const float *gap, const float *leaderSpeed, int begin, int end)
+{
+    for (int i = begin; i < end; i++)
+    {
+        if (!store->active[i])
+        {
+            continue;
+        }
+
+        float speed = store->speed[i];
+        float acceleration = idmAcceleration(&IDM_PARAMETERS[store->type[i]], speed, gap[i], leaderSpeed[i]);
+        float next = speed + acceleration;
+        bool braking = acceleration < -IDM_BRAKING_THRESHOLD;
+        bool stalled = acceleration <= 0.0f && next < IDM_STOPPED_SPEED;
+        store->speed[i] = stalled ? 0.0f : next;
+        if (store->state[i] != STATE_TURNING)
+        {
+            store->state[i] = stalled ? STATE_STOPPED : braking ? STATE_STOPPING : STATE_MOVING;
+        }
+    }
+}
+
+#ifdef VEHICLE_KERNELS_X86
+// mask ? a : b
+TARGET_SSE2 static inline __m128 select128(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+TARGET_SSE2 static inline __m128i select128i(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Four bytes widened to four 32-bit lanes, and back
+TARGET_SSE2 static inline __m128i loadBytes128(const void *bytes)
+{
+    int packed;
+    memcpy(&packed, bytes, sizeof(packed));
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+}
+
+TARGET_SSE2 static inline void storeBytes128(void *bytes, __m128i lanes)
+{
+    __m128i words = _mm_packs_epi32(lanes, lanes);
+    int packed = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+    memcpy(bytes, &packed, sizeof(packed));
+}
+
+// table[type] per lane; SSE2 has no variable permute, so compare and select
+TARGET_SSE2 static inline __m128 lookupType128(__m128i type, const float table[4])
+{
+    __m128 result = _mm_set1_ps(table[0]);
+    for (int t = 1; t < 4; t++)
+    {
+        result = select128(_mm_castsi128_ps(_mm_cmpeq_epi32(type, _mm_set1_epi32(t))), _mm_set1_ps(table[t]), result);
+    }
+    return result;
+}
+
+TARGET_SSE2 static void updateStraightSse2(VehicleStore *store, int begin, int end)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i turnNone = _mm_set1_epi32(TURN_NONE);
+    const __m128i north = _mm_set1_epi32(DIRECTION_NORTH);
+    const __m128i south = _mm_set1_epi32(DIRECTION_SOUTH);
+    const __m128i east = _mm_set1_epi32(DIRECTION_EAST);
+    const __m128i moving = _mm_set1_epi32(STATE_MOVING);
+    const __m128i stopping = _mm_set1_epi32(STATE_STOPPING);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+    const __m128 minBound = _mm_set1_ps(-CULL_MARGIN);
+    const __m128 maxX = _mm_set1_ps(WINDOW_WIDTH + CULL_MARGIN);
+    const __m128 maxY = _mm_set1_ps(WINDOW_HEIGHT + CULL_MARGIN);
+
+    int i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128i active = loadBytes128(store->active + i);
+        __m128i turn = loadBytes128(store->turnDirection + i);
+        __m128i eligible = _mm_andnot_si128(_mm_cmpeq_epi32(active, zero), _mm_cmpeq_epi32(turn, turnNone));
+        if (_mm_movemask_ps(_mm_castsi128_ps(eligible)) == 0)
+        {
+            continue;
+        }
+
+        __m128i direction = loadBytes128(store->direction + i);
+        __m128i state = loadBytes128(store->state + i);
+        __m128 x = _mm_loadu_ps(store->x + i);
+        __m128 y = _mm_loadu_ps(store->y + i);
+        __m128 speed = _mm_loadu_ps(store->speed + i);
+
+        __m128 vertical = _mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(direction, north),
+                                                        _mm_cmpeq_epi32(direction, south)));
+        __m128 positive = _mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(direction, south),
+                                                        _mm_cmpeq_epi32(direction, east)));
+        __m128 sign = select128(positive, one, minusOne);
+        __m128 pos = select128(vertical, y, x);
+
+        __m128 advancing = _mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(state, moving),
+                                                         _mm_cmpeq_epi32(state, stopping)));
+        __m128 newPos = _mm_add_ps(pos, _mm_and_ps(advancing, _mm_mul_ps(sign, speed)));
+        __m128 newX = select128(vertical, x, newPos);
+        __m128 newY = select128(vertical, newPos, y);
+
+        // Only lanes going straight are written back
+        __m128 keep = _mm_castsi128_ps(eligible);
+        _mm_storeu_ps(store->x + i, select128(keep, newX, x));
+        _mm_storeu_ps(store->y + i, select128(keep, newY, y));
+
+        __m128 offScreen = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(newX, minBound), _mm_cmpgt_ps(newX, maxX)),
+                                     _mm_or_ps(_mm_cmplt_ps(newY, minBound), _mm_cmpgt_ps(newY, maxY)));
+        int culled = _mm_movemask_ps(_mm_and_ps(offScreen, keep));
+        for (int lane = 0; culled != 0; lane++, culled >>= 1)
+        {
+            if (culled & 1)
+            {
+                store->active[i + lane] = false;
+            }
+        }
+    }
+    updateStraightScalar(store, i, end);
+}
+
+TARGET_SSE2 static void updateIdmSse2(VehicleStore *store, const float *gap, const float *leaderSpeed, int begin, int end)
+{
+    const IdmTables tables = idmTables();
+    const __m128i zeroi = _mm_setzero_si128();
+    const __m128i moving = _mm_set1_epi32(STATE_MOVING);
+    const __m128i stopping = _mm_set1_epi32(STATE_STOPPING);
+    const __m128i stopped = _mm_set1_epi32(STATE_STOPPED);
+    const __m128i turning = _mm_set1_epi32(STATE_TURNING);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minGap = _mm_set1_ps(IDM_MIN_GAP);
+    const __m128 stallSpeed = _mm_set1_ps(IDM_STOPPED_SPEED);
+    const __m128 brakingThreshold = _mm_set1_ps(-IDM_BRAKING_THRESHOLD);
+
+    int i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128i inactive = _mm_cmpeq_epi32(loadBytes128(store->active + i), zeroi);
+        if (_mm_movemask_ps(_mm_castsi128_ps(inactive)) == 0xF)
+        {
+            continue;
+        }
+
+        __m128i type = loadBytes128(store->type + i);
+        __m128i state = loadBytes128(store->state + i);
+        __m128 speed = _mm_loadu_ps(store->speed + i);
+        __m128 s = _mm_max_ps(_mm_loadu_ps(gap + i), minGap);
+        __m128 closing = _mm_sub_ps(speed, _mm_loadu_ps(leaderSpeed + i));
+
+        __m128 ratio = _mm_div_ps(speed, lookupType128(type, tables.desiredSpeed));
+        __m128 ratio2 = _mm_mul_ps(ratio, ratio);
+        __m128 dynamic = _mm_add_ps(_mm_mul_ps(speed, lookupType128(type, tables.timeHeadway)),
+                                    _mm_div_ps(_mm_mul_ps(speed, closing), lookupType128(type, tables.brakingTerm)));
+        __m128 desiredGap = _mm_add_ps(lookupType128(type, tables.minimumGap), _mm_max_ps(dynamic, zero));
+        __m128 interaction = _mm_div_ps(desiredGap, s);
+        __m128 acceleration = _mm_mul_ps(lookupType128(type, tables.maxAcceleration),
+                                         _mm_sub_ps(_mm_sub_ps(one, _mm_mul_ps(ratio2, ratio2)),
+                                                    _mm_mul_ps(interaction, interaction)));
+
+        __m128 next = _mm_add_ps(speed, acceleration);
+        __m128 braking = _mm_cmplt_ps(acceleration, brakingThreshold);
+        __m128 stalled = _mm_and_ps(_mm_cmple_ps(acceleration, zero), _mm_cmplt_ps(next, stallSpeed));
+        __m128 newSpeed = _mm_andnot_ps(stalled, next);
+        __m128i newState = select128i(_mm_castps_si128(stalled), stopped,
+                                      select128i(_mm_castps_si128(braking), stopping, moving));
+        newState = select128i(_mm_cmpeq_epi32(state, turning), state, newState);
+
+        _mm_storeu_ps(store->speed + i, select128(_mm_castsi128_ps(inactive), speed, newSpeed));
+        storeBytes128(store->state + i, select128i(inactive, state, newState));
+    }
+    updateIdmScalar(store, gap, leaderSpeed, i, end);
+}
+
+// Eight bytes widened to eight 32-bit lanes, and back
+TARGET_AVX2 static inline __m256i loadBytes256(const void *bytes)
+{
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)bytes));
+}
+
+TARGET_AVX2 static inline void storeBytes256(void *bytes, __m256i lanes)
+{
+    __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(lanes), _mm256_extracti128_si256(lanes, 1));
+    _mm_storel_epi64((__m128i *)bytes, _mm_packus_epi16(words, words));
+}
+
+// A four-entry table in the low half of a register, indexed with a permute
+TARGET_AVX2 static inline __m256 typeTable256(const float table[4])
+{
+    return _mm256_setr_ps(table[0], table[1], table[2], table[3], 0, 0, 0, 0);
+}
+
+TARGET_AVX2 static void updateStraightAvx2(VehicleStore *store, int begin, int end)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i turnNone = _mm256_set1_epi32(TURN_NONE);
+    const __m256i north = _mm256_set1_epi32(DIRECTION_NORTH);
+    const __m256i south = _mm256_set1_epi32(DIRECTION_SOUTH);
+    const __m256i moving = _mm256_set1_epi32(STATE_MOVING);
+    const __m256i stopping = _mm256_set1_epi32(STATE_STOPPING);
+    const __m256 signTable = _mm256_setr_ps(DIRECTION_GEOMETRY[0].sign, DIRECTION_GEOMETRY[1].sign,
+                                            DIRECTION_GEOMETRY[2].sign, DIRECTION_GEOMETRY[3].sign,
+                                            0, 0, 0, 0);
+    const __m256 minBound = _mm256_set1_ps(-CULL_MARGIN);
+    const __m256 maxX = _mm256_set1_ps(WINDOW_WIDTH + CULL_MARGIN);
+    const __m256 maxY = _mm256_set1_ps(WINDOW_HEIGHT + CULL_MARGIN);
+
+    int i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256i active = loadBytes256(store->active + i);
+        __m256i turn = loadBytes256(store->turnDirection + i);
+        __m256i eligible = _mm256_andnot_si256(_mm256_cmpeq_epi32(active, zero), _mm256_cmpeq_epi32(turn, turnNone));
+        if (_mm256_movemask_ps(_mm256_castsi256_ps(eligible)) == 0)
+        {
+            continue;
+        }
+
+        __m256i direction = loadBytes256(store->direction + i);
+        __m256i state = loadBytes256(store->state + i);
+        __m256 x = _mm256_loadu_ps(store->x + i);
+        __m256 y = _mm256_loadu_ps(store->y + i);
+        __m256 speed = _mm256_loadu_ps(store->speed + i);
+
+        __m256 vertical = _mm256_castsi256_ps(_mm256_or_si256(_mm256_cmpeq_epi32(direction, north),
+                                                              _mm256_cmpeq_epi32(direction, south)));
+        __m256 sign = _mm256_permutevar8x32_ps(signTable, direction);
+        __m256 pos = _mm256_blendv_ps(x, y, vertical);
+
+        __m256 advancing = _mm256_castsi256_ps(_mm256_or_si256(_mm256_cmpeq_epi32(state, moving),
+                                                               _mm256_cmpeq_epi32(state, stopping)));
+        __m256 newPos = _mm256_add_ps(pos, _mm256_and_ps(advancing, _mm256_mul_ps(sign, speed)));
+        __m256 newX = _mm256_blendv_ps(newPos, x, vertical);
+        __m256 newY = _mm256_blendv_ps(y, newPos, vertical);
+
+        __m256 keep = _mm256_castsi256_ps(eligible);
+        _mm256_storeu_ps(store->x + i, _mm256_blendv_ps(x, newX, keep));
+        _mm256_storeu_ps(store->y + i, _mm256_blendv_ps(y, newY, keep));
+
+        __m256 offScreen = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(newX, minBound, _CMP_LT_OQ), _mm256_cmp_ps(newX, maxX, _CMP_GT_OQ)),
+                                        _mm256_or_ps(_mm256_cmp_ps(newY, minBound, _CMP_LT_OQ), _mm256_cmp_ps(newY, maxY, _CMP_GT_OQ)));
+        int culled = _mm256_movemask_ps(_mm256_and_ps(offScreen, keep));
+        for (int lane = 0; culled != 0; lane++, culled >>= 1)
+        {
+            if (culled & 1)
+            {
+                store->active[i + lane] = false;
+            }
+        }
+    }
+    updateStraightScalar(store, i, end);
+}
+
+TARGET_AVX2 static void updateIdmAvx2(VehicleStore *store, const float *gap, const float *leaderSpeed, int begin, int end)
+{
+    const IdmTables tables = idmTables();
+    const __m256 desiredSpeedTable = typeTable256(tables.desiredSpeed);
+    const __m256 maxAccelerationTable = typeTable256(tables.maxAcceleration);
+    const __m256 minimumGapTable = typeTable256(tables.minimumGap);
+    const __m256 timeHeadwayTable = typeTable256(tables.timeHeadway);
+    const __m256 brakingTermTable = typeTable256(tables.brakingTerm);
+    const __m256i zeroi = _mm256_setzero_si256();
+    const __m256i moving = _mm256_set1_epi32(STATE_MOVING);
+    const __m256i stopping = _mm256_set1_epi32(STATE_STOPPING);
+    const __m256i stopped = _mm256_set1_epi32(STATE_STOPPED);
+    const __m256i turning = _mm256_set1_epi32(STATE_TURNING);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 minGap = _mm256_set1_ps(IDM_MIN_GAP);
+    const __m256 stallSpeed = _mm256_set1_ps(IDM_STOPPED_SPEED);
+    const __m256 brakingThreshold = _mm256_set1_ps(-IDM_BRAKING_THRESHOLD);
+
+    int i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256i inactive = _mm256_cmpeq_epi32(loadBytes256(store->active + i), zeroi);
+        if (_mm256_movemask_ps(_mm256_castsi256_ps(inactive)) == 0xFF)
+        {
+            continue;
+        }
+
+        __m256i type = loadBytes256(store->type + i);
+        __m256i state = loadBytes256(store->state + i);
+        __m256 speed = _mm256_loadu_ps(store->speed + i);
+        __m256 s = _mm256_max_ps(_mm256_loadu_ps(gap + i), minGap);
+        __m256 closing = _mm256_sub_ps(speed, _mm256_loadu_ps(leaderSpeed + i));
+
+        __m256 ratio = _mm256_div_ps(speed, _mm256_permutevar8x32_ps(desiredSpeedTable, type));
+        __m256 ratio2 = _mm256_mul_ps(ratio, ratio);
+        __m256 dynamic = _mm256_add_ps(_mm256_mul_ps(speed, _mm256_permutevar8x32_ps(timeHeadwayTable, type)),
+                                       _mm256_div_ps(_mm256_mul_ps(speed, closing), _mm256_permutevar8x32_ps(brakingTermTable, type)));
+        __m256 desiredGap = _mm256_add_ps(_mm256_permutevar8x32_ps(minimumGapTable, type), _mm256_max_ps(dynamic, zero));
+        __m256 interaction = _mm256_div_ps(desiredGap, s);
+        __m256 acceleration = _mm256_mul_ps(_mm256_permutevar8x32_ps(maxAccelerationTable, type),
+                                            _mm256_sub_ps(_mm256_sub_ps(one, _mm256_mul_ps(ratio2, ratio2)),
+                                                          _mm256_mul_ps(interaction, interaction)));
+
+        __m256 next = _mm256_add_ps(speed, acceleration);
+        __m256 braking = _mm256_cmp_ps(acceleration, brakingThreshold, _CMP_LT_OQ);
+        __m256 stalled = _mm256_and_ps(_mm256_cmp_ps(acceleration, zero, _CMP_LE_OQ), _mm256_cmp_ps(next, stallSpeed, _CMP_LT_OQ));
+        __m256 newSpeed = _mm256_andnot_ps(stalled, next);
+        __m256i newState = _mm256_blendv_epi8(_mm256_blendv_epi8(moving, stopping, _mm256_castps_si256(braking)),
+                                              stopped, _mm256_castps_si256(stalled));
+        newState = _mm256_blendv_epi8(newState, state, _mm256_cmpeq_epi32(state, turning));
+
+        _mm256_storeu_ps(store->speed + i, _mm256_blendv_ps(newSpeed, speed, _mm256_castsi256_ps(inactive)));
+        storeBytes256(store->state + i, _mm256_blendv_epi8(newState, state, inactive));
+    }
+    updateIdmScalar(store, gap, leaderSpeed, i, end);
+}
+#endif
+
+typedef void (*StraightKernelFn)(VehicleStore *store, int begin, int end);
+typedef void (*IdmKernelFn)(VehicleStore *store, const float *gap, const float *leaderSpeed, int begin, int end);
+
+static StraightKernelFn straightKernel = NULL;
+static IdmKernelFn idmKernel = NULL;
+static VehicleKernel straightKernelKind = VEHICLE_KERNEL_SCALAR;
+
+bool selectVehicleKernel(VehicleKernel kernel)
+{
+    switch (kernel)
+    {
+    case VEHICLE_KERNEL_SCALAR:
+        straightKernel = updateStraightScalar;
+        idmKernel = updateIdmScalar;
+        break;
+#ifdef VEHICLE_KERNELS_X86
+    case VEHICLE_KERNEL_SSE2:
+        if (!CPU_HAS_SSE2())
+        {
+            return false;
+        }
+        straightKernel = updateStraightSse2;
+        idmKernel = updateIdmSse2;
+        break;
+    case VEHICLE_KERNEL_AVX2:
+        if (!CPU_HAS_AVX2())
+        {
+            return false;
+        }
+        straightKernel = updateStraightAvx2;
+        idmKernel = updateIdmAvx2;
+        break;
+#endif
+    default:
+        return false;
+    }
+    straightKernelKind = kernel;
+    return true;
+}
+
+VehicleKernel activeVehicleKernel(void)
+{
+    if (straightKernel == NULL)
+    {
+        // Widest first; the scalar kernel always succeeds
+        if (!selectVehicleKernel(VEHICLE_KERNEL_AVX2) && !selectVehicleKernel(VEHICLE_KERNEL_SSE2))
+        {
+            selectVehicleKernel(VEHICLE_KERNEL_SCALAR);
+        }
+    }
+    return straightKernelKind;
+}
+
+const char *vehicleKernelName(VehicleKernel kernel)
+{
+    switch (kernel)
+    {
+    case VEHICLE_KERNEL_SSE2:
+        return "sse2";
+    case VEHICLE_KERNEL_AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+void updateStraightVehicles(VehicleStore *store, int begin, int end)
+{
+    activeVehicleKernel();
+    straightKernel(store, begin, end);
+}
+
+void updateIdmSpeeds(VehicleStore *store, const float *gap, const float *leaderSpeed, int begin, int end)
+{
+    activeVehicleKernel();
+    idmKernel(store, gap, leaderSpeed, begin, end);
+}
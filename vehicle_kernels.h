@@ -0,0 +1,39 @@
+#ifndef VEHICLE_KERNELS_H
+#define VEHICLE_KERNELS_H
+
+#include <stdbool.h>
+#include "traffic_simulation.h"
+#include "vehicle_store.h"
+
+// Batch kernels over the store's field arrays, a SIMD register of vehicles at
+// a time with direction, type and state handled as lane masks instead of
+// switches.
+typedef enum {
+    VEHICLE_KERNEL_SCALAR,
+    VEHICLE_KERNEL_SSE2,
+    VEHICLE_KERNEL_AVX2
+} VehicleKernel;
+
+// Advance every straight vehicle (TURN_NONE) in [begin, end) of the active
+// range by its speed. Vehicles that drive off screen get active = false; the
+// caller still swap-removes them. Vehicles with a turn are left untouched for
+// updateVehicleRef. Only entries inside the range are written, so disjoint
+// ranges can run on different threads.
+void updateStraightVehicles(VehicleStore* store, int begin, int end);
+
+// Intelligent Driver Model step for every active vehicle in [begin, end):
+// gap[i] and leaderSpeed[i] describe what is ahead of dense entry i (see
+// idm.h). Sets the speed for the next move from the IDM_PARAMETERS of the
+// vehicle's type, and the state from the acceleration: MOVING, STOPPING while
+// braking, STOPPED once it stops speeding up below IDM_STOPPED_SPEED.
+// Turning vehicles keep STATE_TURNING.
+void updateIdmSpeeds(VehicleStore* store, const float* gap, const float* leaderSpeed, int begin, int end);
+
+// The widest kernel this CPU supports is picked on first use (call
+// activeVehicleKernel once before going multithreaded); selectVehicleKernel
+// forces another one (returns false if the CPU or build lacks it)
+bool selectVehicleKernel(VehicleKernel kernel);
+VehicleKernel activeVehicleKernel(void);
+const char* vehicleKernelName(VehicleKernel kernel);
+
+#endif
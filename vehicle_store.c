@@ -0,0 +1,298 @@
+#include <stdlib.h>
+#include <string.h>
+#include "vehicle_store.h"
+
+// nextFree marker for slots that are handed out (-1 ends the free list)
+#define SLOT_IN_USE -2
+
+// Resize one field array, zeroing the new tail
+static bool resizeArray(void **array, size_t elementSize, int oldCapacity, int newCapacity)
+{
+    char *resized = (char *)realloc(*array, (size_t)newCapacity * elementSize);
+    if (resized == NULL)
+    {
+        return false;
+    }
+    memset(resized + (size_t)oldCapacity * elementSize, 0, (size_t)(newCapacity - oldCapacity) * elementSize);
+    *array = resized;
+    return true;
+}
+
+// Grow every array to newCapacity and put the new slots on the free list,
+// lowest index first. Arrays that grew before a failure simply stay larger;
+// capacity only changes once all of them succeeded.
+static bool growVehicleStore(VehicleStore *store, int newCapacity)
+{
+    int oldCapacity = store->capacity;
+    if (!resizeArray((void **)&store->x, sizeof(float), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->y, sizeof(float), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->speed, sizeof(float), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->turnAngle, sizeof(float), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->type, sizeof(uint8_t), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->direction, sizeof(uint8_t), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->turnDirection, sizeof(uint8_t), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->state, sizeof(uint8_t), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->active, sizeof(bool), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->isInRightLane, sizeof(bool), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->turnProgress, sizeof(float), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->inLaneQueue, sizeof(bool), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->queueTicket, sizeof(unsigned int), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->inPriorityQueue, sizeof(bool), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->priorityTicket, sizeof(unsigned int), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->denseToSlot, sizeof(int), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->slotToDense, sizeof(int), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->generation, sizeof(uint16_t), oldCapacity, newCapacity) ||
+        !resizeArray((void **)&store->nextFree, sizeof(int), oldCapacity, newCapacity))
+    {
+        return false;
+    }
+
+    for (int i = newCapacity - 1; i >= oldCapacity; i--)
+    {
+        store->nextFree[i] = store->freeHead;
+        store->freeHead = i;
+    }
+    store->capacity = newCapacity;
+    return true;
+}
+
+#define SWAP_FIELD(type, array, a, b) \
+    do                                \
+    {                                 \
+        type swapped = (array)[a];    \
+        (array)[a] = (array)[b];      \
+        (array)[b] = swapped;         \
+    } while (0)
+
+// Exchange two dense entries and fix up their slots' back references
+static void swapDense(VehicleStore *store, int a, int b)
+{
+    if (a == b)
+    {
+        return;
+    }
+    SWAP_FIELD(float, store->x, a, b);
+    SWAP_FIELD(float, store->y, a, b);
+    SWAP_FIELD(float, store->speed, a, b);
+    SWAP_FIELD(float, store->turnAngle, a, b);
+    SWAP_FIELD(uint8_t, store->type, a, b);
+    SWAP_FIELD(uint8_t, store->direction, a, b);
+    SWAP_FIELD(uint8_t, store->turnDirection, a, b);
+    SWAP_FIELD(uint8_t, store->state, a, b);
+    SWAP_FIELD(bool, store->active, a, b);
+    SWAP_FIELD(bool, store->isInRightLane, a, b);
+    SWAP_FIELD(float, store->turnProgress, a, b);
+    SWAP_FIELD(bool, store->inLaneQueue, a, b);
+    SWAP_FIELD(unsigned int, store->queueTicket, a, b);
+    SWAP_FIELD(bool, store->inPriorityQueue, a, b);
+    SWAP_FIELD(unsigned int, store->priorityTicket, a, b);
+    SWAP_FIELD(int, store->denseToSlot, a, b);
+    store->slotToDense[store->denseToSlot[a]] = a;
+    store->slotToDense[store->denseToSlot[b]] = b;
+}
+
+bool initVehicleStore(VehicleStore *store, int capacity)
+{
+    memset(store, 0, sizeof(VehicleStore));
+    store->freeHead = -1;
+    if (capacity > VEHICLE_STORE_MAX_CAPACITY)
+    {
+        capacity = VEHICLE_STORE_MAX_CAPACITY;
+    }
+    if (!growVehicleStore(store, capacity > 0 ? capacity : 1))
+    {
+        freeVehicleStore(store);
+        return false;
+    }
+    return true;
+}
+
+void freeVehicleStore(VehicleStore *store)
+{
+    free(store->x);
+    free(store->y);
+    free(store->speed);
+    free(store->turnAngle);
+    free(store->type);
+    free(store->direction);
+    free(store->turnDirection);
+    free(store->state);
+    free(store->active);
+    free(store->isInRightLane);
+    free(store->turnProgress);
+    free(store->inLaneQueue);
+    free(store->queueTicket);
+    free(store->inPriorityQueue);
+    free(store->priorityTicket);
+    free(store->denseToSlot);
+    free(store->slotToDense);
+    free(store->generation);
+    free(store->nextFree);
+    memset(store, 0, sizeof(VehicleStore));
+    store->freeHead = -1;
+}
+
+VehicleHandle vehicleStoreSpawn(VehicleStore *store, const Vehicle *vehicle)
+{
+    if (store->freeHead < 0)
+    {
+        if (store->capacity >= VEHICLE_STORE_MAX_CAPACITY)
+        {
+            return INVALID_VEHICLE_HANDLE;
+        }
+        int newCapacity = store->capacity * 2;
+        if (newCapacity > VEHICLE_STORE_MAX_CAPACITY)
+        {
+            newCapacity = VEHICLE_STORE_MAX_CAPACITY;
+        }
+        if (!growVehicleStore(store, newCapacity))
+        {
+            return INVALID_VEHICLE_HANDLE;
+        }
+    }
+
+    int slot = store->freeHead;
+    store->freeHead = store->nextFree[slot];
+    store->nextFree[slot] = SLOT_IN_USE;
+
+    // Append after the last live entry, then move it into the active range
+    int index = store->liveCount++;
+    store->denseToSlot[index] = slot;
+    store->slotToDense[slot] = index;
+    vehicleStorePut(store, index, vehicle);
+    store->inPriorityQueue[index] = false;
+    if (vehicle->active)
+    {
+        swapDense(store, index, store->activeCount);
+        store->activeCount++;
+        swapDense(store, store->activeCount - 1, store->awakeCount);
+        store->awakeCount++;
+    }
+    return MAKE_VEHICLE_HANDLE(slot, store->generation[slot]);
+}
+
+void vehicleStoreDeactivate(VehicleStore *store, int index)
+{
+    if (index >= store->activeCount)
+    {
+        return;
+    }
+    if (index < store->awakeCount)
+    {
+        // Through the end of the awake range, which then gives up its last entry
+        store->awakeCount--;
+        swapDense(store, index, store->awakeCount);
+        index = store->awakeCount;
+    }
+    store->active[index] = false;
+    store->activeCount--;
+    swapDense(store, index, store->activeCount);
+}
+
+void vehicleStorePark(VehicleStore *store, int index)
+{
+    if (index >= store->awakeCount)
+    {
+        return;
+    }
+    store->awakeCount--;
+    swapDense(store, index, store->awakeCount);
+}
+
+void vehicleStoreWake(VehicleStore *store, int index)
+{
+    if (index < store->awakeCount || index >= store->activeCount)
+    {
+        return;
+    }
+    swapDense(store, index, store->awakeCount);
+    store->awakeCount++;
+}
+
+void vehicleStoreRelease(VehicleStore *store, VehicleHandle handle)
+{
+    if (!vehicleStoreIsLive(store, handle))
+    {
+        return;
+    }
+    int slot = VEHICLE_HANDLE_INDEX(handle);
+    vehicleStoreDeactivate(store, store->slotToDense[slot]);
+
+    store->liveCount--;
+    swapDense(store, store->slotToDense[slot], store->liveCount);
+    store->inLaneQueue[store->liveCount] = false;
+
+    store->generation[slot] = (uint16_t)((store->generation[slot] + 1) & VEHICLE_GENERATION_MASK);
+    store->nextFree[slot] = store->freeHead;
+    store->freeHead = slot;
+}
+
+bool vehicleStoreIsLive(const VehicleStore *store, VehicleHandle handle)
+{
+    int slot = VEHICLE_HANDLE_INDEX(handle);
+    return handle != INVALID_VEHICLE_HANDLE && slot < store->capacity &&
+           store->generation[slot] == VEHICLE_HANDLE_GENERATION(handle) &&
+           store->nextFree[slot] == SLOT_IN_USE;
+}
+
+int vehicleStoreIndex(const VehicleStore *store, VehicleHandle handle)
+{
+    return vehicleStoreIsLive(store, handle) ? store->slotToDense[VEHICLE_HANDLE_INDEX(handle)] : -1;
+}
+
+VehicleHandle vehicleStoreHandle(const VehicleStore *store, int index)
+{
+    int slot = store->denseToSlot[index];
+    return MAKE_VEHICLE_HANDLE(slot, store->generation[slot]);
+}
+
+VehicleRef vehicleStoreRef(VehicleStore *store, int index)
+{
+    VehicleRef ref = {
+        .x = &store->x[index],
+        .y = &store->y[index],
+        .speed = &store->speed[index],
+        .turnAngle = &store->turnAngle[index],
+        .type = &store->type[index],
+        .direction = &store->direction[index],
+        .turnDirection = &store->turnDirection[index],
+        .state = &store->state[index],
+        .active = &store->active[index],
+        .isInRightLane = &store->isInRightLane[index],
+        .turnProgress = &store->turnProgress[index]};
+    return ref;
+}
+
+void vehicleStorePut(VehicleStore *store, int index, const Vehicle *vehicle)
+{
+    store->x[index] = vehicle->x;
+    store->y[index] = vehicle->y;
+    store->speed[index] = vehicle->speed;
+    store->turnAngle[index] = vehicle->turnAngle;
+    store->type[index] = vehicle->type;
+    store->direction[index] = vehicle->direction;
+    store->turnDirection[index] = vehicle->turnDirection;
+    store->state[index] = vehicle->state;
+    store->active[index] = vehicle->active;
+    store->isInRightLane[index] = vehicle->isInRightLane;
+    store->turnProgress[index] = vehicle->turnProgress;
+    store->inLaneQueue[index] = vehicle->inLaneQueue;
+    store->queueTicket[index] = vehicle->queueTicket;
+}
+
+void vehicleStoreGet(const VehicleStore *store, int index, Vehicle *out)
+{
+    out->x = store->x[index];
+    out->y = store->y[index];
+    out->speed = store->speed[index];
+    out->turnAngle = store->turnAngle[index];
+    out->type = store->type[index];
+    out->direction = store->direction[index];
+    out->turnDirection = store->turnDirection[index];
+    out->state = store->state[index];
+    out->active = store->active[index];
+    out->isInRightLane = store->isInRightLane[index];
+    out->turnProgress = store->turnProgress[index];
+    out->inLaneQueue = store->inLaneQueue[index];
+    out->queueTicket = store->queueTicket[index];
+}
@@ -0,0 +1,92 @@
+#ifndef VEHICLE_STORE_H
+#define VEHICLE_STORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "traffic_simulation.h"
+
+// Slots the store starts with; it doubles whenever the free list runs dry
+#define VEHICLE_STORE_INITIAL_CAPACITY 64
+// Highest slot count a handle can address (the last index would collide with
+// INVALID_VEHICLE_HANDLE)
+#define VEHICLE_STORE_MAX_CAPACITY ((1 << VEHICLE_INDEX_BITS) - 1)
+
+// Structure-of-arrays vehicle storage: one contiguous array per field. Loops
+// that only need positions or states stream through those arrays instead of
+// striding over whole Vehicle structs, and the float arrays are laid out for
+// vectorized updates.
+//
+// The field arrays are kept packed: entries [0, activeCount) are the vehicles
+// still on the road, [activeCount, liveCount) are inactive vehicles whose
+// handle is still held by a lane queue. Deactivating or releasing a vehicle
+// swap-removes it into the next region, so render loops walk only
+// [0, activeCount) with no holes.
+//
+// The active range is itself split: [0, awakeCount) are the vehicles the
+// per-tick update has to look at, [awakeCount, activeCount) are parked ones
+// waiting at a red light (wait_lists.h), which the update skips until they
+// are woken.
+//
+// Because entries move, callers outside those loops hold generational
+// VehicleHandles (stable slot + generation) and map them to the current
+// dense index with vehicleStoreIndex. Slots come from an intrusive free list,
+// so spawning and releasing are O(1) (amortized when the arrays grow).
+typedef struct VehicleStore {
+    // Per-vehicle fields, indexed by dense index
+    float* x;
+    float* y;
+    float* speed;
+    float* turnAngle;
+    uint8_t* type;              // VehicleType, one byte like in Vehicle
+    uint8_t* direction;         // Direction
+    uint8_t* turnDirection;     // TurnDirection
+    uint8_t* state;             // VehicleState
+    bool* active;
+    bool* isInRightLane;
+    float* turnProgress;
+    bool* inLaneQueue;          // handle is held by a lane queue; the slot must not be released yet
+    unsigned int* queueTicket;  // from enqueue; queuePositionOf turns it into a position
+    bool* inPriorityQueue;      // still counted as waiting by its approach's PriorityQueue
+    unsigned int* priorityTicket; // from priorityEnqueue, to remove exactly this vehicle
+    int* denseToSlot;
+    int awakeCount;
+    int activeCount;
+    int liveCount;              // slots currently handed out
+
+    // Per-slot bookkeeping, indexed by VEHICLE_HANDLE_INDEX
+    int* slotToDense;
+    uint16_t* generation;       // bumped on release, wraps at VEHICLE_GENERATION_MASK
+    int* nextFree;              // free list link, -1 ends the list
+    int freeHead;
+    int capacity;
+} VehicleStore;
+
+bool initVehicleStore(VehicleStore* store, int capacity);
+void freeVehicleStore(VehicleStore* store);
+
+// Take a slot for the vehicle, growing the store if needed. Returns
+// INVALID_VEHICLE_HANDLE only when the store cannot grow any further.
+VehicleHandle vehicleStoreSpawn(VehicleStore* store, const Vehicle* vehicle);
+// Mark the vehicle at a dense index inactive and swap it out of the active
+// range; the entry at that index is now the previously last awake vehicle
+// (or last parked one, if the vehicle was parked)
+void vehicleStoreDeactivate(VehicleStore* store, int index);
+// Move an awake vehicle into the parked range / a parked one back, swapping
+// it with the entry at the boundary. New vehicles start awake.
+void vehicleStorePark(VehicleStore* store, int index);
+void vehicleStoreWake(VehicleStore* store, int index);
+// Give the slot back; stale handles are ignored
+void vehicleStoreRelease(VehicleStore* store, VehicleHandle handle);
+bool vehicleStoreIsLive(const VehicleStore* store, VehicleHandle handle);
+// Dense index for a handle, -1 if it is stale
+int vehicleStoreIndex(const VehicleStore* store, VehicleHandle handle);
+// Handle for the vehicle currently at a dense index
+VehicleHandle vehicleStoreHandle(const VehicleStore* store, int index);
+
+// Accessor layer: a VehicleRef into a dense entry lets updateVehicleRef run in place
+VehicleRef vehicleStoreRef(VehicleStore* store, int index);
+// Scatter a Vehicle into a dense entry / gather it back
+void vehicleStorePut(VehicleStore* store, int index, const Vehicle* vehicle);
+void vehicleStoreGet(const VehicleStore* store, int index, Vehicle* out);
+
+#endif
@@ -0,0 +1,120 @@
+#include <stdlib.h>
+#include <string.h>
+#include "wait_lists.h"
+#include "idm.h"
+
+static bool appendToList(WaitLists *lists, int lane, VehicleHandle handle)
+{
+    if (lists->laneCount[lane] == lists->laneCapacity[lane])
+    {
+        int capacity = lists->laneCapacity[lane] > 0 ? lists->laneCapacity[lane] * 2 : 64;
+        VehicleHandle *grown = (VehicleHandle *)realloc(lists->lanes[lane], (size_t)capacity * sizeof(VehicleHandle));
+        if (grown == NULL)
+        {
+            return false;
+        }
+        lists->lanes[lane] = grown;
+        lists->laneCapacity[lane] = capacity;
+    }
+    lists->lanes[lane][lists->laneCount[lane]++] = handle;
+    return true;
+}
+
+void initWaitLists(WaitLists *lists)
+{
+    memset(lists, 0, sizeof(WaitLists));
+}
+
+void freeWaitLists(WaitLists *lists)
+{
+    for (int lane = 0; lane < LANE_QUEUE_COUNT; lane++)
+    {
+        free(lists->lanes[lane]);
+    }
+    memset(lists, 0, sizeof(WaitLists));
+}
+
+int parkStoppedVehicles(WaitLists *lists, const LaneOrder *order, VehicleStore *store, const TrafficLight *lights)
+{
+    int parked = 0;
+    for (int lane = 0; lane < LANE_QUEUE_COUNT; lane++)
+    {
+        const VehicleHandle *entries = order->lanes[lane];
+        int ahead = -1;              // dense index of the previous entry
+        bool aheadParked = false;
+        for (int k = 0; k < order->laneCount[lane]; k++)
+        {
+            int index = vehicleStoreIndex(store, entries[k]);
+            if (index < 0)
+            {
+                ahead = -1;
+                aheadParked = false;
+                continue;
+            }
+            if (index >= store->awakeCount)
+            {
+                // Already parked
+                ahead = index;
+                aheadParked = true;
+                continue;
+            }
+
+            // Parked only if whatever is nearest ahead cannot move (a parked
+            // vehicle, or the red light) and the driver model keeps the
+            // vehicle at rest in front of it, rather than letting it creep up
+            bool waits = false;
+            if (store->state[index] == STATE_STOPPED && store->speed[index] == 0)
+            {
+                float leaderGap = ahead >= 0 ? laneAdvance(store, ahead) - laneAdvance(store, index) - VEHICLE_LENGTH
+                                             : IDM_FREE_GAP;
+                float lightGap = redLightGap(store, index, lights);
+                bool lightHolds = lightGap < IDM_FREE_GAP && lightGap <= leaderGap;
+                float gap = lightHolds ? lightGap : leaderGap;
+                waits = (aheadParked || lightHolds) &&
+                        idmAcceleration(&IDM_PARAMETERS[store->type[index]], 0.0f, gap, 0.0f) <= 0.0f;
+            }
+
+            // The entry moves when parked, so the handle finds it again
+            VehicleHandle handle = entries[k];
+            if (waits && appendToList(lists, lane, handle))
+            {
+                vehicleStorePark(store, index);
+                index = vehicleStoreIndex(store, handle);
+                parked++;
+            }
+            else
+            {
+                waits = false;
+            }
+            ahead = index;
+            aheadParked = waits;
+        }
+    }
+    return parked;
+}
+
+int wakeWaitingVehicles(WaitLists *lists, VehicleStore *store, unsigned int turnedGreen)
+{
+    int woken = 0;
+    for (int direction = 0; direction < 4; direction++)
+    {
+        if (!(turnedGreen & (1u << direction)))
+        {
+            continue;
+        }
+        for (int lane = LANE_QUEUE_INDEX(direction, 0); lane <= LANE_QUEUE_INDEX(direction, LANES_PER_DIRECTION - 1); lane++)
+        {
+            for (int k = 0; k < lists->laneCount[lane]; k++)
+            {
+                int index = vehicleStoreIndex(store, lists->lanes[lane][k]);
+                if (index >= 0)
+                {
+                    vehicleStoreWake(store, index);
+                    woken++;
+                }
+            }
+            lists->laneCount[lane] = 0;
+        }
+    }
+    return woken;
+}
@@ -0,0 +1,37 @@
+#ifndef WAIT_LISTS_H
+#define WAIT_LISTS_H
+
+#include "traffic_simulation.h"
+#include "vehicle_store.h"
+#include "car_following.h"
+
+// Sleep/wake scheduling for vehicles queued at red lights. A vehicle stopped
+// with its light as the nearest obstacle, or stopped right behind a parked
+// vehicle, cannot move until that light turns green: the driver model leaves
+// it at speed 0 tick after tick. Such vehicles are parked (moved out of the
+// store's awake range, so the per-tick update skips them) and filed on their
+// lane's wait list. updateTrafficLights reports which lights turned green and
+// wakeWaitingVehicles moves those lanes' lists back in bulk, so a congested
+// approach costs nothing per tick while it waits. Parking reorders the dense
+// range, but nothing in a step depends on that order (box admission goes
+// lane by lane), so the simulation is the same as without parking.
+typedef struct {
+    VehicleHandle* lanes[LANE_QUEUE_COUNT];
+    int laneCount[LANE_QUEUE_COUNT];
+    int laneCapacity[LANE_QUEUE_COUNT];
+} WaitLists;
+
+void initWaitLists(WaitLists* lists);
+void freeWaitLists(WaitLists* lists);
+
+// After the driver model, walk each lane front to back and park every vehicle
+// that can only wait. Returns how many were parked; a vehicle that does not
+// fit on a full list when memory runs out simply stays awake.
+int parkStoppedVehicles(WaitLists* lists, const LaneOrder* order, VehicleStore* store, const TrafficLight* lights);
+
+// Wake every vehicle waiting on the lanes of the directions set in
+// turnedGreen (1 << Direction, as updateTrafficLights returns it). Returns
+// how many woke.
+int wakeWaitingVehicles(WaitLists* lists, VehicleStore* store, unsigned int turnedGreen);
+
+#endif